@@ -1,56 +1,142 @@
 #include "bloom_filter.h"
 #include <cstring>
 #include <cmath>
+#include <algorithm>
 
-BloomFilter::BloomFilter() : bitArray(WORD_COUNT) {
-    for (size_t i = 0; i < WORD_COUNT; ++i) {
+BloomFilter::BloomFilter() {
+    init(DEFAULT_SIZE, DEFAULT_HASH_COUNT, BloomLayout::Standard);
+}
+
+BloomFilter::BloomFilter(size_t expectedElements, double falsePositiveRate, BloomLayout bloomLayout) {
+    size_t bits = optimalBitCount(expectedElements, falsePositiveRate);
+    if (bloomLayout == BloomLayout::Blocked) {
+        bits = (bits + BLOCK_BITS - 1) / BLOCK_BITS * BLOCK_BITS;
+    }
+    init(bits, optimalHashCount(bits, expectedElements), bloomLayout);
+}
+
+size_t BloomFilter::optimalBitCount(size_t expectedElements, double falsePositiveRate) {
+    double n = static_cast<double>(std::max<size_t>(expectedElements, 1));
+    double p = std::min(std::max(falsePositiveRate, 1e-12), 0.5);
+    double bits = std::ceil(-n * std::log(p) / (std::log(2.0) * std::log(2.0)));
+    size_t words = (static_cast<size_t>(bits) + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    return std::max<size_t>(words, 1) * BITS_PER_WORD;
+}
+
+size_t BloomFilter::optimalHashCount(size_t bits, size_t expectedElements) {
+    double n = static_cast<double>(std::max<size_t>(expectedElements, 1));
+    size_t k = static_cast<size_t>(std::lround(static_cast<double>(bits) / n * std::log(2.0)));
+    return std::min(std::max<size_t>(k, 1), MAX_HASH_COUNT);
+}
+
+void BloomFilter::init(size_t bits, size_t hashes, BloomLayout bloomLayout) {
+    layout = bloomLayout;
+    kernel = bestKernel();
+    size = bits;
+    hashCount = hashes;
+    blockCount = size / BLOCK_BITS;
+    
+    size_t padding = layout == BloomLayout::Blocked ? WORDS_PER_BLOCK - 1 : 0;
+    bitArray = std::vector<std::atomic<uint64_t>>(size / BITS_PER_WORD + padding);
+    for (size_t i = 0; i < bitArray.size(); ++i) {
         bitArray[i] = 0;
     }
+    wordOffset = 0;
+    if (layout == BloomLayout::Blocked) {
+        uintptr_t misalignment = reinterpret_cast<uintptr_t>(bitArray.data()) % (BLOCK_BITS / 8);
+        wordOffset = misalignment ? (BLOCK_BITS / 8 - misalignment) / sizeof(uint64_t) : 0;
+    }
+    
+    // Seeds come from a fixed splitmix64 sequence, so filters with the same
+    // parameters hash identically.
+    uint64_t state = 0x1234ABCDF0F0F0F0ULL;
+    seeds.resize(hashCount);
+    for (size_t i = 0; i < hashCount; ++i) {
+        state += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        seeds[i] = z ^ (z >> 31);
+    }
+}
+
+// MurmurHash3's 64-bit finalizer over the seeded value. The full 64 bits are
+// kept so reduce() can address filters larger than 2^32 bits.
+uint64_t BloomFilter::hash(uint32_t value, uint64_t seed) const {
+    uint64_t h = seed ^ value;
+    
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    
+    return h;
+}
+
+void BloomFilter::probePositions(uint32_t value, size_t* positions) const {
+    uint64_t firstHash = hash(value, seeds[0]);
+    size_t start = blockStart(firstHash);
+    
+    positions[0] = bitIndex(firstHash, start);
+    for (size_t i = 1; i < hashCount; ++i) {
+        positions[i] = bitIndex(hash(value, seeds[i]), start);
+    }
+}
+
+void BloomFilter::prefetchPositions(const size_t* positions, bool forWrite) const {
+    // A blocked key's bits all share one line.
+    size_t lines = layout == BloomLayout::Blocked ? 1 : hashCount;
+    for (size_t i = 0; i < lines; ++i) {
+        const std::atomic<uint64_t>* target = &word(positions[i] / BITS_PER_WORD);
+        if (forWrite) {
+            __builtin_prefetch(target, 1);
+        } else {
+            __builtin_prefetch(target, 0);
+        }
+    }
 }
 
-uint32_t BloomFilter::hash(uint32_t value, uint32_t seed) const {
-    uint32_t h = seed;
+void BloomFilter::setBit(size_t pos) {
+    auto [wordIdx, bitOffset] = getBitPosition(pos);
     
-    h ^= value;
-    h *= 0x5bd1e995;
-    h ^= h >> 15;
-    h *= 0x27d4eb2d;
-    h ^= h >> 15;
+    uint64_t mask = 1ULL << bitOffset;
+    uint64_t oldWord, newWord;
     
-    return h % SIZE;
+    do {
+        oldWord = word(wordIdx).load(std::memory_order_relaxed);
+        newWord = oldWord | mask;
+    } while (!word(wordIdx).compare_exchange_weak(
+        oldWord, newWord, 
+        std::memory_order_release, 
+        std::memory_order_relaxed));
+}
+
+bool BloomFilter::testBit(size_t pos) const {
+    auto [wordIdx, bitOffset] = getBitPosition(pos);
+    
+    uint64_t bits = word(wordIdx).load(std::memory_order_acquire);
+    return bits & (1ULL << bitOffset);
 }
 
 void BloomFilter::add(int v) {
-    uint32_t value = static_cast<uint32_t>(v);
+    size_t positions[MAX_HASH_COUNT];
+    probePositions(static_cast<uint32_t>(v), positions);
     
-    for (size_t i = 0; i < HASH_COUNT; ++i) {
-        uint32_t pos = hash(value, seeds[i]);
-        auto [wordIdx, bitOffset] = getBitPosition(pos);
-        
-        uint64_t mask = 1ULL << bitOffset;
-        uint64_t oldWord, newWord;
-        
-        do {
-            oldWord = bitArray[wordIdx].load(std::memory_order_relaxed);
-            newWord = oldWord | mask;
-        } while (!bitArray[wordIdx].compare_exchange_weak(
-            oldWord, newWord, 
-            std::memory_order_release, 
-            std::memory_order_relaxed));
+    for (size_t i = 0; i < hashCount; ++i) {
+        setBit(positions[i]);
     }
 }
 
 bool BloomFilter::contains(int v) const {
     uint32_t value = static_cast<uint32_t>(v);
+    uint64_t firstHash = hash(value, seeds[0]);
+    size_t start = blockStart(firstHash);
     
-    for (size_t i = 0; i < HASH_COUNT; ++i) {
-        uint32_t pos = hash(value, seeds[i]);
-        auto [wordIdx, bitOffset] = getBitPosition(pos);
-        
-        uint64_t word = bitArray[wordIdx].load(std::memory_order_acquire);
-        uint64_t mask = 1ULL << bitOffset;
-        
-        if (!(word & mask)) {
+    // Hashes lazily so a miss on an early bit skips the remaining hashes.
+    for (size_t i = 0; i < hashCount; ++i) {
+        size_t pos = bitIndex(i == 0 ? firstHash : hash(value, seeds[i]), start);
+        if (!testBit(pos)) {
             return false;
         }
     }
@@ -58,30 +144,95 @@ bool BloomFilter::contains(int v) const {
     return true;
 }
 
+// Both batch calls run a ring of BATCH_WINDOW slots: at step i the key that
+// was hashed and prefetched BATCH_WINDOW steps earlier is probed, then key i
+// takes over its slot.
+void BloomFilter::add_batch(const uint32_t* keys, size_t n) {
+    size_t positions[BATCH_WINDOW][MAX_HASH_COUNT];
+    
+    for (size_t i = 0; i < n + BATCH_WINDOW; ++i) {
+        size_t* slot = positions[i % BATCH_WINDOW];
+        if (i >= BATCH_WINDOW) {
+            for (size_t j = 0; j < hashCount; ++j) {
+                setBit(slot[j]);
+            }
+        }
+        if (i < n) {
+            probePositions(keys[i], slot);
+            prefetchPositions(slot, true);
+        }
+    }
+}
+
+void BloomFilter::contains_batch(const uint32_t* keys, size_t n, uint64_t* results) const {
+    size_t done = 0;
+    if (kernel == BloomKernel::AVX512) {
+        done = containsBatchAVX512(keys, n, results);
+    } else if (kernel == BloomKernel::AVX2) {
+        done = containsBatchAVX2(keys, n, results);
+    }
+    if (done == n) {
+        return;
+    }
+    
+    // The vector kernels stop on a multiple of 64 keys, so the tail starts
+    // on a fresh bitmap word.
+    containsBatchScalar(keys + done, n - done, results + done / 64);
+}
+
+void BloomFilter::containsBatchScalar(const uint32_t* keys, size_t n, uint64_t* results) const {
+    size_t positions[BATCH_WINDOW][MAX_HASH_COUNT];
+    
+    for (size_t i = 0; i < n + BATCH_WINDOW; ++i) {
+        size_t* slot = positions[i % BATCH_WINDOW];
+        if (i >= BATCH_WINDOW) {
+            size_t key = i - BATCH_WINDOW;
+            bool present = true;
+            for (size_t j = 0; j < hashCount && present; ++j) {
+                present = testBit(slot[j]);
+            }
+            if (key % 64 == 0) {
+                results[key / 64] = 0;
+            }
+            results[key / 64] |= static_cast<uint64_t>(present) << (key % 64);
+        }
+        if (i < n) {
+            probePositions(keys[i], slot);
+            prefetchPositions(slot, false);
+        }
+    }
+}
+
+void BloomFilter::clear() {
+    for (size_t i = 0; i < bitArray.size(); ++i) {
+        bitArray[i].store(0, std::memory_order_relaxed);
+    }
+}
+
 void BloomFilter::print() const {
-    std::cout << "Bloom Filter (size: " << SIZE << " bits, " 
-              << HASH_COUNT << " hash functions)" << std::endl;
+    std::cout << "Bloom Filter (size: " << size << " bits, " 
+              << hashCount << " hash functions"
+              << (layout == BloomLayout::Blocked ? ", 512-bit blocks" : "") << ")" << std::endl;
     
     size_t setBits = 0;
-    for (size_t i = 0; i < WORD_COUNT; ++i) {
-        uint64_t word = bitArray[i].load(std::memory_order_relaxed);
-        setBits += __builtin_popcountll(word);
+    for (size_t i = 0; i < bitArray.size(); ++i) {
+        setBits += __builtin_popcountll(bitArray[i].load(std::memory_order_relaxed));
     }
     
-    double fillRatio = static_cast<double>(setBits) / SIZE;
-    double theoreticalFPP = std::pow(fillRatio, HASH_COUNT);
+    double fillRatio = static_cast<double>(setBits) / size;
+    double theoreticalFPP = std::pow(fillRatio, hashCount);
     
-    std::cout << "Set bits: " << setBits << " / " << SIZE 
+    std::cout << "Set bits: " << setBits << " / " << size 
               << " (" << std::fixed << std::setprecision(4) 
               << fillRatio * 100 << "%)" << std::endl;
     std::cout << "Theoretical false positive probability: " 
               << std::setprecision(8) << theoreticalFPP << std::endl;
     
     std::cout << "First 64 bits: ";
-    for (size_t i = 0; i < 64 && i < SIZE; ++i) {
+    for (size_t i = 0; i < 64 && i < size; ++i) {
         auto [wordIdx, bitOffset] = getBitPosition(i);
-        uint64_t word = bitArray[wordIdx].load(std::memory_order_relaxed);
-        std::cout << ((word & (1ULL << bitOffset)) ? '1' : '0');
+        uint64_t bits = word(wordIdx).load(std::memory_order_relaxed);
+        std::cout << ((bits & (1ULL << bitOffset)) ? '1' : '0');
     }
     std::cout << std::endl;
 }
@@ -7,29 +7,119 @@
 #include <iostream>
 #include <iomanip>
 
+// Standard spreads a key's k bits over the whole array, one cache miss each.
+// Blocked picks one 64-byte block per key and sets all k bits inside it, so a
+// query touches a single cache line at the price of a higher FPR for the same m.
+enum class BloomLayout { Standard, Blocked };
+
+// How contains_batch hashes and probes: one key at a time with prefetching, or
+// 4 (AVX2) / 8 (AVX-512) keys per vector with gathered word tests. Picked at
+// runtime from what the CPU supports.
+enum class BloomKernel { Scalar, AVX2, AVX512 };
+
 class BloomFilter {
 private:
-    static const size_t SIZE = 1 << 24;
-    static const size_t HASH_COUNT = 3;
-    static const size_t BITS_PER_WORD = 64;
-    static const size_t WORD_COUNT = (SIZE + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    static constexpr size_t DEFAULT_SIZE = 1 << 24;
+    static constexpr size_t DEFAULT_HASH_COUNT = 3;
+    static constexpr size_t MAX_HASH_COUNT = 32;
+    static constexpr size_t BITS_PER_WORD = 64;
+    static constexpr size_t BLOCK_BITS = 512;
+    static constexpr size_t WORDS_PER_BLOCK = BLOCK_BITS / BITS_PER_WORD;
+    // Keys hashed and prefetched ahead of the one being probed in the batch calls.
+    static constexpr size_t BATCH_WINDOW = 16;
+    
+    BloomLayout layout;
+    BloomKernel kernel;
+    // m bits, always a whole number of words (of blocks when Blocked).
+    size_t size;
+    size_t hashCount;
+    size_t blockCount;
     
+    // Blocked filters over-allocate one block and start at wordOffset so every
+    // block sits on its own cache line.
     std::vector<std::atomic<uint64_t>> bitArray;
+    size_t wordOffset;
+    
+    // One per hash function.
+    std::vector<uint64_t> seeds;
+    
+    void init(size_t bits, size_t hashes, BloomLayout bloomLayout);
+    
+    uint64_t hash(uint32_t value, uint64_t seed) const;
+    
+    // Lemire's multiply-shift range reduction: maps a 64-bit hash onto [0, size)
+    // with one multiply instead of a division.
+    static size_t reduce(uint64_t h, size_t range) {
+        return static_cast<size_t>((static_cast<unsigned __int128>(h) * range) >> 64);
+    }
+    
+    // First bit of the key's block, from the first hash; unused when Standard.
+    size_t blockStart(uint64_t firstHash) const {
+        return layout == BloomLayout::Blocked ? reduce(firstHash, blockCount) * BLOCK_BITS : 0;
+    }
+    
+    // Bit set by one hash: anywhere when Standard, low bits within the block
+    // when Blocked (the block itself came from the high bits of the first hash).
+    size_t bitIndex(uint64_t h, size_t start) const {
+        return layout == BloomLayout::Blocked ? start + (h & (BLOCK_BITS - 1)) : reduce(h, size);
+    }
     
-    const uint32_t seeds[HASH_COUNT] = {0x1234ABCD, 0xF0F0F0F0, 0xAAAA5555};
+    std::atomic<uint64_t>& word(size_t index) { return bitArray[wordOffset + index]; }
+    const std::atomic<uint64_t>& word(size_t index) const { return bitArray[wordOffset + index]; }
     
-    uint32_t hash(uint32_t value, uint32_t seed) const;
+    // Fills positions[0..hashCount) with the key's bit indexes.
+    void probePositions(uint32_t value, size_t* positions) const;
+    // Prefetches every cache line the positions touch.
+    void prefetchPositions(const size_t* positions, bool forWrite) const;
+    void setBit(size_t pos);
+    bool testBit(size_t pos) const;
+    
+    void containsBatchScalar(const uint32_t* keys, size_t n, uint64_t* results) const;
+    // In bloom_filter_simd.cpp; each handles whole vectors and returns how many
+    // keys it covered, leaving the tail to the scalar kernel.
+    size_t containsBatchAVX2(const uint32_t* keys, size_t n, uint64_t* results) const;
+    size_t containsBatchAVX512(const uint32_t* keys, size_t n, uint64_t* results) const;
     
     std::pair<size_t, size_t> getBitPosition(size_t bitIndex) const {
         return {bitIndex / BITS_PER_WORD, bitIndex % BITS_PER_WORD};
     }
     
 public:
+    // 2^24 bits and 3 hash functions.
     BloomFilter();
+    // Sized for expectedElements keys at the given false-positive rate; a
+    // Blocked filter gets the same m and k, so it has a somewhat higher FPR.
+    BloomFilter(size_t expectedElements, double falsePositiveRate,
+                BloomLayout bloomLayout = BloomLayout::Standard);
+    
+    // m = -n ln p / (ln 2)^2, rounded up to whole words.
+    static size_t optimalBitCount(size_t expectedElements, double falsePositiveRate);
+    // k = (m / n) ln 2, at least 1.
+    static size_t optimalHashCount(size_t bits, size_t expectedElements);
+    
+    size_t bitCount() const { return size; }
+    size_t hashFunctionCount() const { return hashCount; }
+    BloomLayout bloomLayout() const { return layout; }
+    
+    static bool kernelSupported(BloomKernel k);
+    static BloomKernel bestKernel();
+    // Returns false, leaving the kernel unchanged, when this CPU lacks k.
+    bool useKernel(BloomKernel k);
+    BloomKernel activeKernel() const { return kernel; }
     
     void add(int v);
     bool contains(int v) const;
     
+    // Same as calling add or contains on each key, but hashes BATCH_WINDOW keys
+    // ahead and prefetches their words, so the cache misses of a filter larger
+    // than the cache overlap instead of stalling one key at a time. Bit i of
+    // results (word i / 64) is set when keys[i] may be present; the bitmap needs
+    // (n + 63) / 64 words.
+    void add_batch(const uint32_t* keys, size_t n);
+    void contains_batch(const uint32_t* keys, size_t n, uint64_t* results) const;
+    
+    void clear();
+    
     void print() const;
 };
 
@@ -0,0 +1,233 @@
+#include "bloom_filter.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Vector kernels for contains_batch. They compute exactly the same positions
+// as probePositions: MurmurHash3's fmix64 over seed ^ key, then either the
+// multiply-shift reduction onto [0, size) or a block chosen from the first hash
+// plus the low 9 bits of each hash. Lanes are 64 bits wide because the hashes
+// and positions are, so AVX2 does 4 keys per vector and AVX-512 does 8.
+//
+// Words are fetched with gathers rather than std::atomic loads. On x86 each
+// aligned 8-byte element load is single-copy atomic and ordinary loads already
+// have acquire ordering, so this matches what the scalar path observes.
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "gathers index the bit array as plain words");
+
+bool BloomFilter::kernelSupported(BloomKernel k) {
+#if defined(__x86_64__)
+    switch (k) {
+    case BloomKernel::AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+    case BloomKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+    default:
+        return true;
+    }
+#else
+    return k == BloomKernel::Scalar;
+#endif
+}
+
+BloomKernel BloomFilter::bestKernel() {
+    static const BloomKernel best = kernelSupported(BloomKernel::AVX512) ? BloomKernel::AVX512
+                                  : kernelSupported(BloomKernel::AVX2)   ? BloomKernel::AVX2
+                                                                         : BloomKernel::Scalar;
+    return best;
+}
+
+bool BloomFilter::useKernel(BloomKernel k) {
+    if (!kernelSupported(k)) {
+        return false;
+    }
+    kernel = k;
+    return true;
+}
+
+#if defined(__x86_64__)
+
+// Like containsBatchScalar, the kernels keep BATCH_WINDOW keys in flight: at
+// vector step v they probe the vector hashed and prefetched BATCH_WINDOW keys
+// earlier, then hash vector v into its ring slot and prefetch its lines. A
+// deeper window issues more prefetches than the core can track and only adds
+// hashing work. They stop on a multiple of 64 keys so every result word is
+// written whole.
+static constexpr size_t RESULT_BITS = 64;
+
+// positions holds lanes entries per hash function.
+static void prefetchVector(const long long* words, const uint64_t* positions, size_t lanes, size_t lines) {
+    for (size_t i = 0; i < lanes * lines; ++i) {
+        __builtin_prefetch(words + (positions[i] >> 6), 0);
+    }
+}
+
+// AVX2 has neither a 64-bit multiply low nor high, so both are built from
+// 32x32->64 partial products.
+__attribute__((target("avx2")))
+static inline __m256i mulLo64AVX2(__m256i a, __m256i b) {
+    __m256i loLo = _mm256_mul_epu32(a, b);
+    __m256i hiLo = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+    __m256i loHi = _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32));
+    return _mm256_add_epi64(loLo, _mm256_slli_epi64(_mm256_add_epi64(hiLo, loHi), 32));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i mulHi64AVX2(__m256i a, __m256i b) {
+    const __m256i low32 = _mm256_set1_epi64x(0xFFFFFFFF);
+    __m256i aHi = _mm256_srli_epi64(a, 32);
+    __m256i bHi = _mm256_srli_epi64(b, 32);
+    __m256i loLo = _mm256_mul_epu32(a, b);
+    __m256i hiLo = _mm256_mul_epu32(aHi, b);
+    __m256i loHi = _mm256_mul_epu32(a, bHi);
+    __m256i hiHi = _mm256_mul_epu32(aHi, bHi);
+    __m256i cross = _mm256_add_epi64(_mm256_srli_epi64(loLo, 32),
+                                     _mm256_add_epi64(_mm256_and_si256(hiLo, low32), _mm256_and_si256(loHi, low32)));
+    __m256i high = _mm256_add_epi64(hiHi, _mm256_add_epi64(_mm256_srli_epi64(hiLo, 32), _mm256_srli_epi64(loHi, 32)));
+    return _mm256_add_epi64(high, _mm256_srli_epi64(cross, 32));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i fmix64AVX2(__m256i h) {
+    h = _mm256_xor_si256(h, _mm256_srli_epi64(h, 33));
+    h = mulLo64AVX2(h, _mm256_set1_epi64x(0xFF51AFD7ED558CCDULL));
+    h = _mm256_xor_si256(h, _mm256_srli_epi64(h, 33));
+    h = mulLo64AVX2(h, _mm256_set1_epi64x(0xC4CEB9FE1A85EC53ULL));
+    return _mm256_xor_si256(h, _mm256_srli_epi64(h, 33));
+}
+
+__attribute__((target("avx2")))
+size_t BloomFilter::containsBatchAVX2(const uint32_t* keys, size_t n, uint64_t* results) const {
+    constexpr size_t LANES = 4;
+    constexpr size_t RING = BATCH_WINDOW / LANES;
+    const long long* words = reinterpret_cast<const long long*>(&word(0));
+    const bool blocked = layout == BloomLayout::Blocked;
+    const size_t lines = blocked ? 1 : hashCount;
+    const __m256i range = _mm256_set1_epi64x(static_cast<long long>(blocked ? blockCount : size));
+    const __m256i blockMask = _mm256_set1_epi64x(BLOCK_BITS - 1);
+    const __m256i bitMask = _mm256_set1_epi64x(BITS_PER_WORD - 1);
+    const __m256i one = _mm256_set1_epi64x(1);
+    alignas(64) uint64_t positions[RING][MAX_HASH_COUNT * LANES];
+    size_t covered = n / RESULT_BITS * RESULT_BITS;
+    size_t vectors = covered / LANES;
+
+    for (size_t v = 0; v < vectors + RING; ++v) {
+        uint64_t* slot = positions[v % RING];
+        if (v >= RING) {
+            size_t first = (v - RING) * LANES;
+            __m256i present = _mm256_set1_epi64x(-1);
+            for (size_t j = 0; j < hashCount; ++j) {
+                __m256i pos = _mm256_load_si256(reinterpret_cast<const __m256i*>(slot + j * LANES));
+                __m256i bits = _mm256_mask_i64gather_epi64(_mm256_setzero_si256(), words, _mm256_srli_epi64(pos, 6),
+                                                           present, 8);
+                __m256i bit = _mm256_and_si256(_mm256_srlv_epi64(bits, _mm256_and_si256(pos, bitMask)), one);
+                present = _mm256_and_si256(present, _mm256_cmpeq_epi64(bit, one));
+                if (_mm256_testz_si256(present, present)) {
+                    break;
+                }
+            }
+            if (first % RESULT_BITS == 0) {
+                results[first / RESULT_BITS] = 0;
+            }
+            results[first / RESULT_BITS] |=
+                static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(present))) << (first % RESULT_BITS);
+        }
+        if (v < vectors) {
+            __m256i values = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + v * LANES)));
+            __m256i firstHash = fmix64AVX2(_mm256_xor_si256(values, _mm256_set1_epi64x(seeds[0])));
+            __m256i start = blocked ? _mm256_slli_epi64(mulHi64AVX2(firstHash, range), 9) : _mm256_setzero_si256();
+            for (size_t j = 0; j < hashCount; ++j) {
+                __m256i h = j == 0 ? firstHash : fmix64AVX2(_mm256_xor_si256(values, _mm256_set1_epi64x(seeds[j])));
+                __m256i pos = blocked ? _mm256_add_epi64(start, _mm256_and_si256(h, blockMask)) : mulHi64AVX2(h, range);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(slot + j * LANES), pos);
+            }
+            prefetchVector(words, slot, LANES, lines);
+        }
+    }
+    return covered;
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static inline __m512i fmix64AVX512(__m512i h) {
+    h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+    h = _mm512_mullo_epi64(h, _mm512_set1_epi64(0xFF51AFD7ED558CCDULL));
+    h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+    h = _mm512_mullo_epi64(h, _mm512_set1_epi64(0xC4CEB9FE1A85EC53ULL));
+    return _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+}
+
+// AVX-512 has a 64-bit multiply low but still no high half.
+__attribute__((target("avx512f,avx512dq")))
+static inline __m512i mulHi64AVX512(__m512i a, __m512i b) {
+    const __m512i low32 = _mm512_set1_epi64(0xFFFFFFFF);
+    __m512i aHi = _mm512_srli_epi64(a, 32);
+    __m512i bHi = _mm512_srli_epi64(b, 32);
+    __m512i loLo = _mm512_mul_epu32(a, b);
+    __m512i hiLo = _mm512_mul_epu32(aHi, b);
+    __m512i loHi = _mm512_mul_epu32(a, bHi);
+    __m512i hiHi = _mm512_mul_epu32(aHi, bHi);
+    __m512i cross = _mm512_add_epi64(_mm512_srli_epi64(loLo, 32),
+                                     _mm512_add_epi64(_mm512_and_si512(hiLo, low32), _mm512_and_si512(loHi, low32)));
+    __m512i high = _mm512_add_epi64(hiHi, _mm512_add_epi64(_mm512_srli_epi64(hiLo, 32), _mm512_srli_epi64(loHi, 32)));
+    return _mm512_add_epi64(high, _mm512_srli_epi64(cross, 32));
+}
+
+__attribute__((target("avx512f,avx512dq")))
+size_t BloomFilter::containsBatchAVX512(const uint32_t* keys, size_t n, uint64_t* results) const {
+    constexpr size_t LANES = 8;
+    constexpr size_t RING = BATCH_WINDOW / LANES;
+    const long long* words = reinterpret_cast<const long long*>(&word(0));
+    const bool blocked = layout == BloomLayout::Blocked;
+    const size_t lines = blocked ? 1 : hashCount;
+    const __m512i range = _mm512_set1_epi64(static_cast<long long>(blocked ? blockCount : size));
+    const __m512i blockMask = _mm512_set1_epi64(BLOCK_BITS - 1);
+    const __m512i bitMask = _mm512_set1_epi64(BITS_PER_WORD - 1);
+    const __m512i one = _mm512_set1_epi64(1);
+    alignas(64) uint64_t positions[RING][MAX_HASH_COUNT * LANES];
+    size_t covered = n / RESULT_BITS * RESULT_BITS;
+    size_t vectors = covered / LANES;
+
+    for (size_t v = 0; v < vectors + RING; ++v) {
+        uint64_t* slot = positions[v % RING];
+        if (v >= RING) {
+            size_t first = (v - RING) * LANES;
+            __mmask8 present = 0xFF;
+            for (size_t j = 0; j < hashCount && present; ++j) {
+                __m512i pos = _mm512_load_si512(slot + j * LANES);
+                __m512i bits = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), present, _mm512_srli_epi64(pos, 6),
+                                                           words, 8);
+                __m512i bit = _mm512_srlv_epi64(bits, _mm512_and_si512(pos, bitMask));
+                present = _mm512_mask_test_epi64_mask(present, bit, one);
+            }
+            if (first % RESULT_BITS == 0) {
+                results[first / RESULT_BITS] = 0;
+            }
+            results[first / RESULT_BITS] |= static_cast<uint64_t>(present) << (first % RESULT_BITS);
+        }
+        if (v < vectors) {
+            __m512i values = _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + v * LANES)));
+            __m512i firstHash = fmix64AVX512(_mm512_xor_si512(values, _mm512_set1_epi64(seeds[0])));
+            __m512i start = blocked ? _mm512_slli_epi64(mulHi64AVX512(firstHash, range), 9) : _mm512_setzero_si512();
+            for (size_t j = 0; j < hashCount; ++j) {
+                __m512i h = j == 0 ? firstHash : fmix64AVX512(_mm512_xor_si512(values, _mm512_set1_epi64(seeds[j])));
+                __m512i pos = blocked ? _mm512_add_epi64(start, _mm512_and_si512(h, blockMask)) : mulHi64AVX512(h, range);
+                _mm512_store_si512(slot + j * LANES, pos);
+            }
+            prefetchVector(words, slot, LANES, lines);
+        }
+    }
+    return covered;
+}
+
+#else
+
+size_t BloomFilter::containsBatchAVX2(const uint32_t*, size_t, uint64_t*) const {
+    return 0;
+}
+
+size_t BloomFilter::containsBatchAVX512(const uint32_t*, size_t, uint64_t*) const {
+    return 0;
+}
+
+#endif
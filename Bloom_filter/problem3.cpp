@@ -109,10 +109,221 @@ void runTest2(int numThreads) {
     filter.print();
 }
 
+void runTest3() {
+    std::cout << "\n==== Unit Test 3: Sizing from Expected Elements and FPR ====" << std::endl;
+    
+    const size_t elementCounts[] = {10000, 1000000};
+    const double targetRates[] = {0.01, 0.001};
+    
+    std::cout << std::setw(10) << "n" << std::setw(10) << "target" << std::setw(14) << "m (bits)" 
+              << std::setw(6) << "k" << std::setw(12) << "measured" << std::setw(8) << "ok" << std::endl;
+    
+    for (size_t n : elementCounts) {
+        for (double target : targetRates) {
+            BloomFilter filter(n, target);
+            // Members are 0, 2, 4, ...; odd keys were never added.
+            for (size_t i = 0; i < n; ++i) {
+                filter.add(static_cast<int>(2 * i));
+            }
+            
+            size_t missing = 0;
+            size_t falsePositives = 0;
+            for (size_t i = 0; i < n; ++i) {
+                if (!filter.contains(static_cast<int>(2 * i))) missing++;
+                if (filter.contains(static_cast<int>(2 * i + 1))) falsePositives++;
+            }
+            
+            double measured = static_cast<double>(falsePositives) / n;
+            // Allow for sampling noise on the smaller sets.
+            bool ok = missing == 0 && measured < target * 1.5;
+            std::cout << std::setw(10) << n << std::setw(10) << std::setprecision(4) << target 
+                      << std::setw(14) << filter.bitCount() << std::setw(6) << filter.hashFunctionCount() 
+                      << std::setw(12) << std::setprecision(5) << measured << std::setw(8) 
+                      << (ok ? "yes" : "NO") << std::endl;
+        }
+    }
+    
+    size_t largeBits = BloomFilter::optimalBitCount(500000000, 0.01);
+    std::cout << "500M keys at 1% would take " << largeBits / 8 / (1 << 20) << " MiB and " 
+              << BloomFilter::optimalHashCount(largeBits, 500000000) << " hash functions" << std::endl;
+}
+
+void runLayoutComparison() {
+    std::cout << "\n==== Standard vs Blocked Layout (same m and k, 1% target FPR, 1 thread) ====" << std::endl;
+    
+    // The first set fits in cache; the second is far larger than the LLC.
+    const size_t elementCounts[] = {1000000, 16000000};
+    
+    std::cout << std::setw(10) << "Layout" << std::setw(11) << "n" << std::setw(10) << "MiB" 
+              << std::setw(4) << "k" << std::setw(11) << "FPR" << std::setw(14) << "add Mops/s" 
+              << std::setw(18) << "contains Mops/s" << std::endl;
+    
+    for (size_t n : elementCounts) {
+        for (BloomLayout layout : {BloomLayout::Standard, BloomLayout::Blocked}) {
+            BloomFilter filter(n, 0.01, layout);
+            
+            auto addStart = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < n; ++i) {
+                filter.add(static_cast<int>(2 * i));
+            }
+            std::chrono::duration<double> addElapsed = std::chrono::high_resolution_clock::now() - addStart;
+            
+            // Alternate members and non-members so both early-exit and full probes count.
+            size_t falsePositives = 0;
+            size_t found = 0;
+            auto queryStart = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < n; ++i) {
+                found += filter.contains(static_cast<int>(2 * i));
+                falsePositives += filter.contains(static_cast<int>(2 * i + 1));
+            }
+            std::chrono::duration<double> queryElapsed = std::chrono::high_resolution_clock::now() - queryStart;
+            
+            if (found != n) {
+                std::cerr << "FAIL: filter lost " << n - found << " members" << std::endl;
+            }
+            std::cout << std::setw(10) << (layout == BloomLayout::Blocked ? "blocked" : "standard") 
+                      << std::setw(11) << n << std::setw(10) << std::fixed << std::setprecision(2) 
+                      << filter.bitCount() / 8.0 / (1 << 20) << std::setw(4) << filter.hashFunctionCount() 
+                      << std::setw(11) << std::setprecision(5) << static_cast<double>(falsePositives) / n 
+                      << std::setw(14) << std::setprecision(2) << n / addElapsed.count() / 1e6 
+                      << std::setw(18) << 2 * n / queryElapsed.count() / 1e6 << std::endl;
+        }
+    }
+}
+
+void runBatchComparison() {
+    std::cout << "\n==== Scalar vs Batched (prefetching) add/contains, 1% target FPR, 1 thread ====" << std::endl;
+    
+    const size_t elementCounts[] = {1000000, 16000000};
+    
+    std::cout << std::setw(10) << "Layout" << std::setw(11) << "n" 
+              << std::setw(13) << "add Mops/s" << std::setw(13) << "batch" 
+              << std::setw(18) << "contains Mops/s" << std::setw(13) << "batch" 
+              << std::setw(10) << "match" << std::endl;
+    
+    for (size_t n : elementCounts) {
+        std::vector<uint32_t> members(n);
+        // Members and non-members alternate, as in the layout comparison.
+        std::vector<uint32_t> queries(2 * n);
+        for (size_t i = 0; i < n; ++i) {
+            members[i] = static_cast<uint32_t>(2 * i);
+            queries[2 * i] = static_cast<uint32_t>(2 * i);
+            queries[2 * i + 1] = static_cast<uint32_t>(2 * i + 1);
+        }
+        
+        for (BloomLayout layout : {BloomLayout::Standard, BloomLayout::Blocked}) {
+            BloomFilter scalarFilter(n, 0.01, layout);
+            auto start = std::chrono::high_resolution_clock::now();
+            for (uint32_t key : members) {
+                scalarFilter.add(static_cast<int>(key));
+            }
+            std::chrono::duration<double> addElapsed = std::chrono::high_resolution_clock::now() - start;
+            
+            BloomFilter batchFilter(n, 0.01, layout);
+            start = std::chrono::high_resolution_clock::now();
+            batchFilter.add_batch(members.data(), members.size());
+            std::chrono::duration<double> addBatchElapsed = std::chrono::high_resolution_clock::now() - start;
+            
+            std::vector<uint8_t> scalarResults(queries.size());
+            start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < queries.size(); ++i) {
+                scalarResults[i] = scalarFilter.contains(static_cast<int>(queries[i]));
+            }
+            std::chrono::duration<double> queryElapsed = std::chrono::high_resolution_clock::now() - start;
+            
+            std::vector<uint64_t> bitmap((queries.size() + 63) / 64);
+            start = std::chrono::high_resolution_clock::now();
+            batchFilter.contains_batch(queries.data(), queries.size(), bitmap.data());
+            std::chrono::duration<double> queryBatchElapsed = std::chrono::high_resolution_clock::now() - start;
+            
+            // Both filters hold the same keys, so every answer must agree.
+            bool match = true;
+            for (size_t i = 0; i < queries.size(); ++i) {
+                match = match && ((bitmap[i / 64] >> (i % 64)) & 1) == scalarResults[i];
+            }
+            
+            std::cout << std::setw(10) << (layout == BloomLayout::Blocked ? "blocked" : "standard") 
+                      << std::setw(11) << n << std::fixed << std::setprecision(2) 
+                      << std::setw(13) << n / addElapsed.count() / 1e6 
+                      << std::setw(13) << n / addBatchElapsed.count() / 1e6 
+                      << std::setw(18) << queries.size() / queryElapsed.count() / 1e6 
+                      << std::setw(13) << queries.size() / queryBatchElapsed.count() / 1e6 
+                      << std::setw(10) << (match ? "yes" : "NO") << std::endl;
+        }
+    }
+}
+
+const char* kernelName(BloomKernel kernel) {
+    switch (kernel) {
+    case BloomKernel::AVX512: return "avx512";
+    case BloomKernel::AVX2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+void runKernelComparison() {
+    std::cout << "\n==== contains_batch Kernels (1% target FPR, 1 thread) ====" << std::endl;
+    std::cout << "Best kernel on this CPU: " << kernelName(BloomFilter::bestKernel()) << std::endl;
+    
+    const size_t elementCounts[] = {1000000, 16000000};
+    
+    std::cout << std::setw(10) << "Layout" << std::setw(11) << "n" << std::setw(10) << "Kernel" 
+              << std::setw(18) << "contains Mops/s" << std::setw(10) << "speedup" << std::setw(10) << "match" << std::endl;
+    
+    for (size_t n : elementCounts) {
+        std::vector<uint32_t> members(n);
+        std::vector<uint32_t> queries(2 * n + 37);
+        for (size_t i = 0; i < n; ++i) {
+            members[i] = static_cast<uint32_t>(2 * i);
+        }
+        // An odd length so the vector kernels leave a scalar tail.
+        for (size_t i = 0; i < queries.size(); ++i) {
+            queries[i] = static_cast<uint32_t>(i);
+        }
+        size_t bitmapWords = (queries.size() + 63) / 64;
+        
+        for (BloomLayout layout : {BloomLayout::Standard, BloomLayout::Blocked}) {
+            BloomFilter filter(n, 0.01, layout);
+            filter.add_batch(members.data(), members.size());
+            
+            std::vector<uint64_t> reference(bitmapWords);
+            double scalarRate = 0;
+            for (BloomKernel kernel : {BloomKernel::Scalar, BloomKernel::AVX2, BloomKernel::AVX512}) {
+                if (!filter.useKernel(kernel)) {
+                    std::cout << std::setw(10) << "" << std::setw(11) << "" << std::setw(10) << kernelName(kernel) 
+                              << "  not supported" << std::endl;
+                    continue;
+                }
+                
+                std::vector<uint64_t> bitmap(bitmapWords);
+                auto start = std::chrono::high_resolution_clock::now();
+                filter.contains_batch(queries.data(), queries.size(), bitmap.data());
+                std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+                
+                double rate = queries.size() / elapsed.count() / 1e6;
+                if (kernel == BloomKernel::Scalar) {
+                    reference = bitmap;
+                    scalarRate = rate;
+                }
+                
+                std::cout << std::setw(10) << (layout == BloomLayout::Blocked ? "blocked" : "standard") 
+                          << std::setw(11) << n << std::setw(10) << kernelName(kernel) 
+                          << std::fixed << std::setprecision(2) << std::setw(18) << rate 
+                          << std::setw(9) << rate / scalarRate << "x" 
+                          << std::setw(10) << (bitmap == reference ? "yes" : "NO") << std::endl;
+            }
+        }
+    }
+}
+
 int main() {
     BloomFilter testFilter;
     runTest1(testFilter);
     runTest2(4);
+    runTest3();
+    runLayoutComparison();
+    runBatchComparison();
+    runKernelComparison();
     
     std::vector<uint32_t> randomKeys;
     std::ifstream keyFile("bin/random_keys_insert.bin", std::ios::binary);
@@ -5,7 +5,11 @@
 
 
 PthreadHashTable::PthreadHashTable(size_t cap)
-    : capacity(cap), buckets(cap, nullptr), locks(cap), pool_index(0)
+    : capacity(cap), buckets(cap, nullptr), locks(cap), pool_index(0),
+      guard(nullptr), guard_capacity(0), guard_fpr(0.01),
+      guard_rebuild_ratio(0.25), guard_epoch(0), guard_live_keys(0), guard_stale_keys(0),
+      guard_lookups(0), guard_short_circuits(0), guard_rebuilds(0),
+      cache_capacity(0), cache_entries(0), cache_evictions(0), clock_hand(0)
 {
     size_t initial_pool_size = std::min(POOL_SIZE, capacity * 10);
     node_pool.reserve(initial_pool_size);
@@ -21,13 +25,7 @@ PthreadHashTable::PthreadHashTable(size_t cap)
 
 PthreadHashTable::~PthreadHashTable() {
     for (size_t i = 0; i < capacity; i++) {
-        Node* curr = buckets[i];
         buckets[i] = nullptr;
-        while (curr) {
-            Node* temp = curr;
-            curr = curr->next;
-            std::free(temp);
-        }
     }
     
     for (size_t i = 0; i < node_pool.size(); i++) {
@@ -37,6 +35,11 @@ PthreadHashTable::~PthreadHashTable() {
         }
     }
     
+    for (Node* node : overflow_nodes) {
+        std::free(node);
+    }
+    overflow_nodes.clear();
+    
     std::lock_guard<std::mutex> lock(free_list_mutex);
     free_list.clear();
 }
@@ -64,12 +67,13 @@ Node* PthreadHashTable::allocate_node(uint32_t key, uint32_t value) {
                 std::cerr << "Error: Failed to allocate memory for node" << std::endl;
                 exit(1);
             }
+            overflow_nodes.push_back(node);
         }
     }
     
     node->key = key;
     node->value = value;
-    node->next = nullptr;
+    node->link = 0;
     
     return node;
 }
@@ -96,7 +100,7 @@ void PthreadHashTable::print() {
         
         while (curr) {
             std::cout << "(" << curr->key << "->" << curr->value << ") ";
-            curr = curr->next;
+            curr = curr->next();
             chain_length++;
             total_nodes++;
         }
@@ -113,6 +117,154 @@ void PthreadHashTable::print() {
     }
 }
 
+void PthreadHashTable::enable_bloom_guard(double rebuild_ratio, double target_fpr) {
+    guard_rebuild_ratio = rebuild_ratio;
+    guard_fpr = target_fpr;
+    rebuild_bloom_guard();
+}
+
+BloomGuardStats PthreadHashTable::bloom_guard_stats() const {
+    return {guard_lookups.load(std::memory_order_relaxed),
+            guard_short_circuits.load(std::memory_order_relaxed),
+            guard_rebuilds.load(std::memory_order_relaxed),
+            guard_capacity};
+}
+
+// Lookups read the filter without taking a bucket lock, so a rebuild publishes an
+// odd epoch while it clears and refills the bits. A negative answer only counts
+// when the epoch was even and unchanged across the probe, seqlock style.
+bool PthreadHashTable::guard_rejects(uint32_t key) const {
+    uint64_t before = guard_epoch.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+    
+    bool absent = !guard.load(std::memory_order_acquire)->contains(static_cast<int>(key));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    
+    return absent && guard_epoch.load(std::memory_order_relaxed) == before;
+}
+
+void PthreadHashTable::rebuild_bloom_guard() {
+    for (size_t i = 0; i < capacity; ++i) {
+        locks[i].lock();
+    }
+    
+    size_t live = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        for (Node* curr = buckets[i]; curr; curr = curr->next()) {
+            live++;
+        }
+    }
+    
+    guard_epoch.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    BloomFilter* filter = guard.load(std::memory_order_relaxed);
+    size_t wanted = std::max(live * GUARD_HEADROOM, MIN_GUARD_KEYS);
+    if (!filter || wanted > guard_capacity) {
+        guard_filters.push_back(std::make_unique<BloomFilter>(wanted, guard_fpr));
+        filter = guard_filters.back().get();
+        guard_capacity = wanted;
+        guard.store(filter, std::memory_order_release);
+    } else {
+        filter->clear();
+    }
+    
+    for (size_t i = 0; i < capacity; ++i) {
+        for (Node* curr = buckets[i]; curr; curr = curr->next()) {
+            filter->add(static_cast<int>(curr->key));
+        }
+    }
+    
+    guard_live_keys.store(live, std::memory_order_relaxed);
+    guard_stale_keys.store(0, std::memory_order_relaxed);
+    guard_rebuilds.fetch_add(1, std::memory_order_relaxed);
+    guard_epoch.fetch_add(1, std::memory_order_release);
+    
+    for (size_t i = capacity; i-- > 0;) {
+        locks[i].unlock();
+    }
+}
+
+// guard_live_keys counts every key added since the last rebuild, so past
+// guard_capacity the filter is over its sized load and its FPR climbs.
+void PthreadHashTable::maybe_rebuild_bloom_guard() {
+    if (!bloom_guard_enabled()) {
+        return;
+    }
+    
+    size_t stale = guard_stale_keys.load(std::memory_order_relaxed);
+    size_t live = guard_live_keys.load(std::memory_order_relaxed);
+    if ((stale > 0 && stale >= live * guard_rebuild_ratio) || live > guard_capacity) {
+        rebuild_bloom_guard();
+    }
+}
+
+void PthreadHashTable::enable_cache_mode(size_t max_entries) {
+    size_t entries = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        for (Node* curr = buckets[i]; curr; curr = curr->next()) {
+            entries++;
+        }
+    }
+    
+    cache_capacity = std::max<size_t>(1, max_entries);
+    cache_entries.store(entries, std::memory_order_relaxed);
+    evict_to_capacity();
+}
+
+CacheStats PthreadHashTable::cache_stats() const {
+    return {cache_entries.load(std::memory_order_relaxed), cache_capacity,
+            cache_evictions.load(std::memory_order_relaxed)};
+}
+
+// CLOCK over the bucket array: the hand visits one bucket at a time under that
+// bucket's lock, giving recently referenced nodes a second chance and unlinking
+// the rest. Hits only set their node's bit under the lock they already hold, so
+// no global recency list sits on the lookup path. Callers must not hold a bucket
+// lock, and each overflowing insert pays for its own eviction.
+void PthreadHashTable::evict_to_capacity() {
+    while (cache_entries.load(std::memory_order_relaxed) > cache_capacity) {
+        size_t bucket = clock_hand.fetch_add(1, std::memory_order_relaxed) % capacity;
+        size_t evicted = 0;
+        
+        {
+            std::lock_guard<std::mutex> lg(locks[bucket]);
+            Node* curr = buckets[bucket];
+            Node* prev = nullptr;
+            
+            while (curr) {
+                Node* next = curr->next();
+                if (curr->referenced()) {
+                    curr->set_referenced(false);
+                    prev = curr;
+                } else {
+                    if (prev) {
+                        prev->set_next(next);
+                    } else {
+                        buckets[bucket] = next;
+                    }
+                    free_node(curr);
+                    evicted++;
+                    
+                    if (cache_entries.fetch_sub(1, std::memory_order_relaxed) <= cache_capacity + 1) {
+                        break;
+                    }
+                }
+                curr = next;
+            }
+        }
+        
+        if (evicted > 0) {
+            cache_evictions.fetch_add(evicted, std::memory_order_relaxed);
+            if (bloom_guard_enabled()) {
+                guard_stale_keys.fetch_add(evicted, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
 struct InsertArgs {
     PthreadHashTable* ht;
     size_t start;
@@ -124,6 +276,8 @@ struct InsertArgs {
 
 void insert_thread_func(InsertArgs* args) {
     PthreadHashTable* ht = args->ht;
+    bool guarded = ht->bloom_guard_enabled();
+    size_t inserted = 0;
     
     for (size_t i = args->start; i < args->end; ++i) {
         uint32_t key = args->keys[i];
@@ -139,18 +293,33 @@ void insert_thread_func(InsertArgs* args) {
                     exists = true;
                     break;
                 }
-                curr = curr->next;
+                curr = curr->next();
             }
             
             if (!exists) {
+                // Reloaded under the bucket lock: a rebuild holds every lock
+                // while it swaps filters.
+                if (guarded) {
+                    ht->guard.load(std::memory_order_relaxed)->add(static_cast<int>(key));
+                }
+                inserted++;
                 Node* newNode = ht->allocate_node(key, val);
-                newNode->next = ht->buckets[bucket];
+                newNode->set_next(ht->buckets[bucket]);
                 ht->buckets[bucket] = newNode;
                 args->results[i] = true;
             } else {
                 args->results[i] = false;
             }
         }
+        
+        if (ht->cache_capacity != 0 && args->results[i]) {
+            ht->cache_entries.fetch_add(1, std::memory_order_relaxed);
+            ht->evict_to_capacity();
+        }
+    }
+    
+    if (guarded) {
+        ht->guard_live_keys.fetch_add(inserted, std::memory_order_relaxed);
     }
     
     delete args;
@@ -175,6 +344,8 @@ void PthreadHashTable::batch_insert(const uint32_t* keys, const uint32_t* vals,
     for (auto& thr : threads) {
         thr.join();
     }
+    
+    maybe_rebuild_bloom_guard();
 }
 
 struct LookupArgs {
@@ -187,11 +358,19 @@ struct LookupArgs {
 
 void lookup_thread_func(LookupArgs* args) {
     PthreadHashTable* ht = args->ht;
+    bool guarded = ht->bloom_guard_enabled();
+    size_t short_circuited = 0;
     
     for (size_t i = args->start; i < args->end; ++i) {
         uint32_t key = args->keys[i];
         size_t bucket = key % ht->size();
         
+        if (guarded && ht->guard_rejects(key)) {
+            args->results[i] = 0;
+            short_circuited++;
+            continue;
+        }
+        
         std::lock_guard<std::mutex> lg(ht->locks[bucket]);
         
         Node* curr = ht->buckets[bucket];
@@ -200,14 +379,22 @@ void lookup_thread_func(LookupArgs* args) {
         while (curr) {
             if (curr->key == key) {
                 value = curr->value;
+                if (ht->cache_capacity != 0) {
+                    curr->set_referenced(true);
+                }
                 break;
             }
-            curr = curr->next;
+            curr = curr->next();
         }
         
         args->results[i] = value;
     }
     
+    if (guarded) {
+        ht->guard_lookups.fetch_add(args->end - args->start, std::memory_order_relaxed);
+        ht->guard_short_circuits.fetch_add(short_circuited, std::memory_order_relaxed);
+    }
+    
     delete args;
 }
 
@@ -242,6 +429,7 @@ struct DeleteArgs {
 
 void delete_thread_func(DeleteArgs* args) {
     PthreadHashTable* ht = args->ht;
+    size_t deleted = 0;
     
     for (size_t i = args->start; i < args->end; ++i) {
         uint32_t key = args->keys[i];
@@ -256,25 +444,33 @@ void delete_thread_func(DeleteArgs* args) {
         while (curr) {
             if (curr->key == key) {
                 if (prev) {
-                    prev->next = curr->next;
+                    prev->set_next(curr->next());
                 } else {
-                    ht->buckets[bucket] = curr->next;
+                    ht->buckets[bucket] = curr->next();
                 }
                 
                 Node* to_free = curr;
                 ht->free_node(to_free);
                 
                 found = true;
+                deleted++;
                 break;
             }
             
             prev = curr;
-            curr = curr->next;
+            curr = curr->next();
         }
         
         args->results[i] = found;
     }
     
+    if (ht->bloom_guard_enabled()) {
+        ht->guard_stale_keys.fetch_add(deleted, std::memory_order_relaxed);
+    }
+    if (ht->cache_capacity != 0) {
+        ht->cache_entries.fetch_sub(deleted, std::memory_order_relaxed);
+    }
+    
     delete args;
 }
 
@@ -297,6 +493,8 @@ void PthreadHashTable::batch_delete(const uint32_t* keys, size_t n, uint8_t* res
     for (auto& thr : threads) {
         thr.join();
     }
+    
+    maybe_rebuild_bloom_guard();
 }
 
 #ifdef USE_TBB
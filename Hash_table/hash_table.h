@@ -13,15 +13,28 @@
 #include <string>
 #include <iomanip>
 
+#include "../Bloom_filter/bloom_filter.h"
+
 #ifdef USE_TBB
 #include <tbb/concurrent_hash_map.h>
 #endif
 
+// In cache mode the low bit of link is the node's CLOCK reference bit. Nodes
+// are at least 8-byte aligned, so the bit is never part of the address and the
+// node stays 16 bytes.
 struct Node {
     uint32_t key;
     uint32_t value;
-    Node* next;
+    uintptr_t link;
+
+    Node* next() const { return reinterpret_cast<Node*>(link & ~REFERENCED); }
+    void set_next(Node* n) { link = reinterpret_cast<uintptr_t>(n) | (link & REFERENCED); }
+    bool referenced() const { return link & REFERENCED; }
+    void set_referenced(bool on) { link = on ? (link | REFERENCED) : (link & ~REFERENCED); }
+
+    static constexpr uintptr_t REFERENCED = 1;
 };
+static_assert(sizeof(Node) == 2 * sizeof(uint32_t) + sizeof(uintptr_t), "Node must not grow past key, value and link");
 
 class HashTableInterface {
 public:
@@ -40,6 +53,20 @@ struct InsertArgs;
 struct LookupArgs;
 struct DeleteArgs;
 
+struct BloomGuardStats {
+    size_t lookups;
+    size_t short_circuited;
+    size_t rebuilds;
+    // Keys the current filter is sized for.
+    size_t capacity;
+};
+
+struct CacheStats {
+    size_t entries;
+    size_t capacity;
+    size_t evictions;
+};
+
 class PthreadHashTable : public HashTableInterface {
 
 public:
@@ -55,11 +82,30 @@ public:
 
     size_t size() const override { return capacity; }
 
+    // Sizes the filter for target_fpr at twice the live keys and regrows it once
+    // inserts outrun that. Not thread-safe: call before the table is shared
+    // between batches.
+    void enable_bloom_guard(double rebuild_ratio = 0.25, double target_fpr = 0.01);
+    bool bloom_guard_enabled() const { return guard.load(std::memory_order_relaxed) != nullptr; }
+    BloomGuardStats bloom_guard_stats() const;
+
+    // Bounds the table to max_entries keys, evicting with CLOCK once inserts exceed it.
+    // Not thread-safe: call before the table is shared between batches.
+    void enable_cache_mode(size_t max_entries);
+    bool cache_mode_enabled() const { return cache_capacity != 0; }
+    CacheStats cache_stats() const;
+
 private:
     Node* allocate_node(uint32_t key, uint32_t value);
     void free_node(Node* node);
     size_t hash_function(uint32_t key) const { return key % capacity; }
 
+    bool guard_rejects(uint32_t key) const;
+    void rebuild_bloom_guard();
+    void maybe_rebuild_bloom_guard();
+
+    void evict_to_capacity();
+
     size_t capacity;
     std::vector<Node*> buckets;
     std::vector<std::mutex> locks;
@@ -68,10 +114,33 @@ private:
     std::vector<Node*> node_pool;
     std::atomic<size_t> pool_index;
     std::mutex pool_mutex;
+    std::vector<Node*> overflow_nodes;
 
     std::vector<Node*> free_list;
     std::mutex free_list_mutex;
 
+    static constexpr size_t GUARD_HEADROOM = 2;
+    static constexpr size_t MIN_GUARD_KEYS = 1024;
+    // Lookups may still be probing a filter that a rebuild replaced, so every
+    // filter lives in guard_filters until the table goes away. Each replacement
+    // is at least twice the size of the last, so the old ones cost less than it.
+    std::atomic<BloomFilter*> guard;
+    std::vector<std::unique_ptr<BloomFilter>> guard_filters;
+    size_t guard_capacity;
+    double guard_fpr;
+    double guard_rebuild_ratio;
+    std::atomic<uint64_t> guard_epoch;
+    std::atomic<size_t> guard_live_keys;
+    std::atomic<size_t> guard_stale_keys;
+    std::atomic<size_t> guard_lookups;
+    std::atomic<size_t> guard_short_circuits;
+    std::atomic<size_t> guard_rebuilds;
+
+    size_t cache_capacity;
+    std::atomic<size_t> cache_entries;
+    std::atomic<size_t> cache_evictions;
+    std::atomic<size_t> clock_hand;
+
     friend void insert_thread_func(InsertArgs*);
     friend void lookup_thread_func(LookupArgs*);
     friend void delete_thread_func(DeleteArgs*);
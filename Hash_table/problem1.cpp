@@ -10,6 +10,7 @@
 #include <memory>
 #include <random>
 #include <functional>
+#include <cmath>
 
 std::vector<uint32_t> read_binary_file(const std::string& filename, size_t limit = 0) {
     std::ifstream file(filename, std::ios::binary);
@@ -239,11 +240,294 @@ void test3(HashTableInterface* ht) {
     std::cout << "Concurrent deletes: " << (successDeletes == n/2 ? "PASSED" : "FAILED") << std::endl;
 }
 
+#ifndef USE_TBB
+void test4() {
+    std::cout << "\n========= Test 4: Bloom Filter Guard ==========" << std::endl;
+    
+    const size_t n = 1000;
+    PthreadHashTable ht(1000);
+    ht.enable_bloom_guard(0.25);
+    
+    std::vector<uint32_t> keys(n);
+    std::vector<uint32_t> vals(n);
+    std::vector<uint32_t> absent(n);
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = 2 * i + 2;
+        vals[i] = (i + 1) * 100;
+        absent[i] = 2 * i + 1;
+    }
+    
+    std::vector<uint8_t> insertResults(n, 0);
+    ht.batch_insert(keys.data(), vals.data(), n, insertResults.data(), 4);
+    
+    std::vector<uint32_t> lookupResults(n, 0);
+    ht.batch_lookup(keys.data(), n, lookupResults.data(), 4);
+    size_t presentFound = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (lookupResults[i] == vals[i]) presentFound++;
+    }
+    
+    BloomGuardStats beforeMisses = ht.bloom_guard_stats();
+    ht.batch_lookup(absent.data(), n, lookupResults.data(), 4);
+    size_t absentMissed = std::count(lookupResults.begin(), lookupResults.end(), 0u);
+    BloomGuardStats afterMisses = ht.bloom_guard_stats();
+    
+    std::vector<uint8_t> deleteResults(n / 2, 0);
+    ht.batch_delete(keys.data(), n / 2, deleteResults.data(), 4);
+    
+    ht.batch_lookup(keys.data(), n, lookupResults.data(), 4);
+    size_t afterDeleteCorrect = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t expected = (i < n / 2) ? 0 : vals[i];
+        if (lookupResults[i] == expected) afterDeleteCorrect++;
+    }
+    BloomGuardStats stats = ht.bloom_guard_stats();
+    
+    // Outgrow the filter the guard was sized for: it must regrow rather than saturate.
+    const size_t more = 2 * n;
+    std::vector<uint32_t> moreKeys(more);
+    std::vector<uint32_t> moreVals(more);
+    for (size_t i = 0; i < more; i++) {
+        moreKeys[i] = 2 * (n + i) + 2;
+        moreVals[i] = (n + i + 1) * 100;
+    }
+    std::vector<uint8_t> moreResults(more, 0);
+    ht.batch_insert(moreKeys.data(), moreVals.data(), more, moreResults.data(), 4);
+    
+    std::vector<uint32_t> moreLookups(more, 0);
+    ht.batch_lookup(moreKeys.data(), more, moreLookups.data(), 4);
+    size_t grownFound = 0;
+    for (size_t i = 0; i < more; i++) {
+        if (moreLookups[i] == moreVals[i]) grownFound++;
+    }
+    BloomGuardStats grown = ht.bloom_guard_stats();
+    size_t liveKeys = n - n / 2 + more;
+    
+    std::cout << "Present keys found: " << presentFound << "/" << n << std::endl;
+    std::cout << "Absent keys reported missing: " << absentMissed << "/" << n << std::endl;
+    std::cout << "Absent lookups short-circuited: " 
+              << afterMisses.short_circuited - beforeMisses.short_circuited << "/" << n << std::endl;
+    std::cout << "Lookups correct after deletes: " << afterDeleteCorrect << "/" << n << std::endl;
+    std::cout << "Guard rebuilds: " << stats.rebuilds << std::endl;
+    std::cout << "Guard capacity: " << stats.capacity << " -> " << grown.capacity 
+              << " keys for " << liveKeys << " live" << std::endl;
+    
+    std::cout << "\nTest 4 Result:" << std::endl;
+    std::cout << "Guarded lookups: " << (presentFound == n && absentMissed == n ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "Rebuild after deletes: " << (afterDeleteCorrect == n && stats.rebuilds >= 2 ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "Regrow past capacity: " << (grownFound == more && grown.rebuilds > stats.rebuilds && 
+                                               grown.capacity >= liveKeys ? "PASSED" : "FAILED") << std::endl;
+}
+
+void run_bloom_guard_benchmark(int num_threads, size_t bucket_count, size_t n, double miss_ratio) {
+    std::cout << "\n========= Bloom Guard Benchmark ==========" << std::endl;
+    std::cout << "Keys: " << n << ", Lookups: " << n << ", Miss ratio: " 
+              << std::fixed << std::setprecision(2) << miss_ratio << std::endl;
+    
+    // Multiplying by an odd constant is a bijection on uint32_t, so keys drawn from
+    // [0, n) and misses drawn from [n, 2n) never collide but share the same buckets.
+    auto scramble = [](uint32_t i) { return (i + 1) * 0x9E3779B1u; };
+    
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<> coin(0.0, 1.0);
+    
+    std::vector<uint32_t> keys(n);
+    std::vector<uint32_t> vals(n);
+    std::vector<uint32_t> probes(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = scramble(i);
+        vals[i] = i + 1;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        probes[i] = (coin(gen) < miss_ratio) ? scramble(n + gen() % n) : keys[gen() % n];
+    }
+    
+    std::cout << "\n| Guard | Lookup Time (ms) | Throughput (ops/sec) | Short-circuited |" << std::endl;
+    std::cout << "|-------|------------------|----------------------|-----------------|" << std::endl;
+    
+    double baseline_throughput = 0;
+    for (bool guarded : {false, true}) {
+        PthreadHashTable ht(bucket_count);
+        if (guarded) {
+            ht.enable_bloom_guard();
+        }
+        
+        std::vector<uint8_t> insert_results(n, 0);
+        std::vector<uint32_t> lookup_results(n, 0);
+        ht.batch_insert(keys.data(), vals.data(), n, insert_results.data(), num_threads);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        ht.batch_lookup(probes.data(), n, lookup_results.data(), num_threads);
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        double throughput = n * 1000.0 / elapsed_ms;
+        
+        BloomGuardStats stats = ht.bloom_guard_stats();
+        double short_fraction = guarded ? static_cast<double>(stats.short_circuited) / stats.lookups : 0.0;
+        
+        std::cout << "| " << std::setw(5) << (guarded ? "on" : "off") << " | "
+                  << std::setw(16) << std::fixed << std::setprecision(2) << elapsed_ms << " | "
+                  << std::setw(20) << throughput << " | "
+                  << std::setw(14) << short_fraction * 100 << "% |" << std::endl;
+        
+        if (guarded) {
+            std::cout << "Net throughput gain: " << throughput / baseline_throughput << "x" << std::endl;
+        } else {
+            baseline_throughput = throughput;
+        }
+    }
+}
+
+void test5() {
+    std::cout << "\n========= Test 5: Bounded Cache Mode ==========" << std::endl;
+    
+    const size_t n = 1000;
+    const size_t budget = 100;
+    PthreadHashTable ht(256);
+    ht.enable_cache_mode(budget);
+    
+    std::vector<uint32_t> keys(n);
+    std::vector<uint32_t> vals(n);
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = i + 1;
+        vals[i] = (i + 1) * 10;
+    }
+    
+    std::vector<uint8_t> insertResults(n, 0);
+    ht.batch_insert(keys.data(), vals.data(), n, insertResults.data(), 4);
+    CacheStats afterFill = ht.cache_stats();
+    
+    std::vector<uint32_t> hot(keys.end() - 10, keys.end());
+    std::vector<uint32_t> hotResults(hot.size(), 0);
+    ht.batch_lookup(hot.data(), hot.size(), hotResults.data(), 1);
+    
+    std::vector<uint32_t> fresh(budget / 2);
+    std::vector<uint32_t> freshVals(fresh.size(), 7);
+    for (size_t i = 0; i < fresh.size(); i++) {
+        fresh[i] = 100000 + i;
+    }
+    std::vector<uint8_t> freshResults(fresh.size(), 0);
+    ht.batch_insert(fresh.data(), freshVals.data(), fresh.size(), freshResults.data(), 1);
+    
+    size_t resident = 0;
+    std::vector<uint32_t> allResults(n, 0);
+    ht.batch_lookup(keys.data(), n, allResults.data(), 4);
+    for (size_t i = 0; i < n; i++) {
+        if (allResults[i] == vals[i]) resident++;
+    }
+    
+    ht.batch_lookup(hot.data(), hot.size(), hotResults.data(), 1);
+    size_t hotResident = 0;
+    for (size_t i = 0; i < hot.size(); i++) {
+        if (hotResults[i] != 0) hotResident++;
+    }
+    CacheStats stats = ht.cache_stats();
+    
+    std::cout << "Entries after filling " << n << " keys: " << afterFill.entries << "/" << budget << std::endl;
+    std::cout << "Resident keys from first batch: " << resident << std::endl;
+    std::cout << "Referenced keys surviving eviction: " << hotResident << "/" << hot.size() << std::endl;
+    std::cout << "Evictions: " << stats.evictions << std::endl;
+    
+    std::cout << "\nTest 5 Result:" << std::endl;
+    std::cout << "Capacity bound: " << (afterFill.entries <= budget && stats.entries <= budget ? "PASSED" : "FAILED") << std::endl;
+    std::cout << "Second chance for hits: " << (hotResident == hot.size() ? "PASSED" : "FAILED") << std::endl;
+}
+
+class ZipfGenerator {
+public:
+    ZipfGenerator(size_t n, double alpha) : cdf(n) {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), alpha);
+            cdf[i] = sum;
+        }
+        for (double& c : cdf) {
+            c /= sum;
+        }
+    }
+    
+    size_t operator()(std::mt19937& gen) {
+        double u = std::uniform_real_distribution<>(0.0, 1.0)(gen);
+        return std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+    }
+
+private:
+    std::vector<double> cdf;
+};
+
+void run_cache_benchmark(int num_threads, size_t universe, size_t trace_length, double alpha) {
+    std::cout << "\n========= Cache Mode Benchmark ==========" << std::endl;
+    std::cout << "Key universe: " << universe << ", Trace length: " << trace_length 
+              << ", Zipf alpha: " << std::fixed << std::setprecision(2) << alpha << std::endl;
+    
+    auto scramble = [](uint32_t i) { return (i + 1) * 0x9E3779B1u; };
+    
+    std::mt19937 gen(12345);
+    ZipfGenerator zipf(universe, alpha);
+    std::vector<uint32_t> trace(trace_length);
+    for (size_t i = 0; i < trace_length; ++i) {
+        trace[i] = scramble(zipf(gen));
+    }
+    
+    // Requests are served in windows: look the window up, then fill the misses the
+    // way a read-through cache would after fetching them from the backing store.
+    const size_t window = 8192;
+    std::vector<uint32_t> results(window);
+    std::vector<uint32_t> missKeys;
+    std::vector<uint32_t> missVals;
+    std::vector<uint8_t> insertResults(window);
+    
+    std::cout << "\n| Budget (% keys) | Entries | Hit Ratio | Time (ms) | Throughput (ops/sec) | Evictions |" << std::endl;
+    std::cout << "|-----------------|---------|-----------|-----------|----------------------|-----------|" << std::endl;
+    
+    for (double fraction : {0.01, 0.05, 0.10, 0.0}) {
+        size_t budget = static_cast<size_t>(universe * fraction);
+        size_t buckets = budget ? budget : universe;
+        PthreadHashTable ht(buckets);
+        if (budget) {
+            ht.enable_cache_mode(budget);
+        }
+        
+        size_t hits = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t offset = 0; offset < trace_length; offset += window) {
+            size_t count = std::min(window, trace_length - offset);
+            const uint32_t* keys = trace.data() + offset;
+            ht.batch_lookup(keys, count, results.data(), num_threads);
+            
+            missKeys.clear();
+            missVals.clear();
+            for (size_t i = 0; i < count; ++i) {
+                if (results[i] != 0) {
+                    hits++;
+                } else {
+                    missKeys.push_back(keys[i]);
+                    missVals.push_back(keys[i] | 1);
+                }
+            }
+            ht.batch_insert(missKeys.data(), missVals.data(), missKeys.size(), insertResults.data(), num_threads);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        
+        CacheStats stats = ht.cache_stats();
+        std::cout << "| " << std::setw(15) << (budget ? std::to_string(static_cast<int>(fraction * 100)) + "%" : "unbounded")
+                  << " | " << std::setw(7) << (budget ? std::to_string(stats.entries) : "-")
+                  << " | " << std::setw(8) << std::setprecision(2) << 100.0 * hits / trace_length << "%"
+                  << " | " << std::setw(9) << elapsed_ms
+                  << " | " << std::setw(20) << trace_length * 1000.0 / elapsed_ms
+                  << " | " << std::setw(9) << stats.evictions << " |" << std::endl;
+    }
+}
+#endif
+
 int main(int argc, char* argv[]) {
     int num_threads = 4;
     bool run_tests = true;
     bool run_benchmarks = true;
     size_t bucket_count = 10000;
+    double miss_ratio = 0.9;
+    double zipf_alpha = 0.99;
     
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -251,6 +535,10 @@ int main(int argc, char* argv[]) {
             num_threads = std::stoi(argv[++i]);
         } else if (arg == "--buckets" && i + 1 < argc) {
             bucket_count = std::stoul(argv[++i]);
+        } else if (arg == "--miss-ratio" && i + 1 < argc) {
+            miss_ratio = std::stod(argv[++i]);
+        } else if (arg == "--zipf" && i + 1 < argc) {
+            zipf_alpha = std::stod(argv[++i]);
         } else if (arg == "--tests-only") {
             run_benchmarks = false;
         } else if (arg == "--benchmarks-only") {
@@ -260,6 +548,8 @@ int main(int argc, char* argv[]) {
             std::cout << "Options:" << std::endl;
             std::cout << "  --threads N       Number of threads to use (default: 4)" << std::endl;
             std::cout << "  --buckets N       Number of hash table buckets (default: 10000)" << std::endl;
+            std::cout << "  --miss-ratio R    Fraction of absent keys in the Bloom guard benchmark (default: 0.9)" << std::endl;
+            std::cout << "  --zipf A          Zipf skew of the cache benchmark trace (default: 0.99)" << std::endl;
             std::cout << "  --tests-only      Run only the tests, not benchmarks" << std::endl;
             std::cout << "  --benchmarks-only Run only benchmarks, not tests" << std::endl;
             std::cout << "  --help            Display this help message" << std::endl;
@@ -285,11 +575,19 @@ int main(int argc, char* argv[]) {
         test1(ht.get());
         test2(ht.get());
         test3(ht.get());
+#ifndef USE_TBB
+        test4();
+        test5();
+#endif
     }
     
     if (run_benchmarks) {
         std::vector<size_t> input_sizes = {100000, 1000000, 10000000};
         run_benchmark(ht.get(), num_threads, input_sizes);
+#ifndef USE_TBB
+        run_bloom_guard_benchmark(num_threads, bucket_count, 1000000, miss_ratio);
+        run_cache_benchmark(num_threads, 1000000, 4000000, zipf_alpha);
+#endif
     }
     
     return 0;
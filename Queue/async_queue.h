@@ -0,0 +1,93 @@
+#ifndef ASYNC_QUEUE_H
+#define ASYNC_QUEUE_H
+
+#include "ms_queue.h"
+#include "mpsc_queue.h"
+#include <coroutine>
+#include <optional>
+#include <utility>
+
+// Where resumed consumers run. post() may be called from any producer thread.
+class CoroExecutor {
+public:
+    virtual ~CoroExecutor() = default;
+    virtual void post(std::coroutine_handle<> handle) = 0;
+};
+
+// Resumes posted coroutines on whichever thread calls run_pending().
+class LoopExecutor : public CoroExecutor {
+public:
+    LoopExecutor() : ready(createMPSCQueue<std::coroutine_handle<>>()) {}
+    ~LoopExecutor() override { deleteMPSCQueue(ready); }
+
+    void post(std::coroutine_handle<> handle) override { enq(ready, handle); }
+
+    // Returns how many coroutines were resumed.
+    size_t run_pending() {
+        size_t resumed = 0;
+        std::coroutine_handle<> handle;
+        while (try_dequeue(ready, handle)) {
+            handle.resume();
+            resumed++;
+        }
+        return resumed;
+    }
+
+private:
+    MPSCQueue<std::coroutine_handle<>>* ready;
+};
+
+// co_await dequeue_async(q, executor) completes immediately if a value is
+// queued; otherwise the coroutine registers as an AsyncWaiter, an enq hands it
+// the value directly, and it is resumed on executor.
+template <typename T>
+class DequeueAwaiter : private AsyncWaiter {
+public:
+    DequeueAwaiter(MSQueue<T>* q, CoroExecutor* executor) : queue(q), executor(executor) {}
+
+    bool await_ready() {
+        T value{};
+        if (try_dequeue(queue, value)) {
+            result.emplace(std::move(value));
+            return true;
+        }
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        handle = h;
+        slot = &result;
+        wake = &DequeueAwaiter::resumeOnExecutor;
+        // Once registered this awaiter may be resumed, and destroyed, on another
+        // thread at any moment, so nothing below may touch its members.
+        MSQueue<T>* q = queue;
+        if (publishAsyncWaiter(q, this)) {
+            matchAsyncWaiters(q);
+        }
+    }
+
+    T await_resume() { return std::move(*result); }
+
+private:
+    static void resumeOnExecutor(AsyncWaiter* waiter) {
+        DequeueAwaiter* self = static_cast<DequeueAwaiter*>(waiter);
+        CoroExecutor* target = self->executor;
+        std::coroutine_handle<> h = self->handle;
+        target->post(h);
+    }
+
+    MSQueue<T>* queue;
+    CoroExecutor* executor;
+    std::coroutine_handle<> handle;
+    std::optional<T> result;
+};
+
+// Suspending costs one seq_cst fence; only the first suspension on a queue
+// issues asymmetricHeavyFence(). From then on every enq on that queue pays a
+// seq_cst fence too.
+template <typename T>
+DequeueAwaiter<T> dequeue_async(MSQueue<T>* q, CoroExecutor* executor) {
+    return DequeueAwaiter<T>(q, executor);
+}
+
+#endif
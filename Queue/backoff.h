@@ -0,0 +1,71 @@
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#include "cpu_relax.h"
+#include <cstdint>
+
+// What a thread does after losing a CAS race before it retries.
+enum class BackoffPolicy {
+    None,         // retry immediately
+    Pause,        // one spin-loop hint
+    Exponential,  // spin 4, 8, ... up to MAX_SPINS hints
+    Randomized    // spin a random count below the exponential limit
+};
+
+inline const char* backoffName(BackoffPolicy policy) {
+    switch (policy) {
+    case BackoffPolicy::None: return "none";
+    case BackoffPolicy::Pause: return "pause";
+    case BackoffPolicy::Exponential: return "exponential";
+    case BackoffPolicy::Randomized: return "randomized";
+    }
+    return "unknown";
+}
+
+// One per operation: the exponential limit starts over on every enq/deq.
+class Backoff {
+public:
+    static constexpr uint32_t MIN_SPINS = 4;
+    static constexpr uint32_t MAX_SPINS = 1024;
+
+    explicit Backoff(BackoffPolicy policy) : policy(policy), limit(MIN_SPINS) {}
+
+    void pause() {
+        switch (policy) {
+        case BackoffPolicy::None:
+            return;
+        case BackoffPolicy::Pause:
+            cpuRelax();
+            return;
+        case BackoffPolicy::Exponential:
+            spin(limit);
+            break;
+        case BackoffPolicy::Randomized:
+            spin(nextRandom() & (limit - 1));
+            break;
+        }
+        if (limit < MAX_SPINS) {
+            limit <<= 1;
+        }
+    }
+
+private:
+    static void spin(uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            cpuRelax();
+        }
+    }
+
+    static uint32_t nextRandom() {
+        static thread_local uint32_t state = 0x9E3779B9u ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state));
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    BackoffPolicy policy;
+    uint32_t limit;
+};
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include "cpu_relax.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Queue benchmark driver that keeps its own bookkeeping off the measured path:
+// every thread's operations are generated before the clock starts, counters
+// are thread-local and published once at the end, and all threads are released
+// together from a barrier.
+
+// Schedule entry meaning "dequeue"; anything else is a value to enqueue.
+constexpr int32_t BENCH_DEQ = INT32_MIN;
+
+struct BenchConfig {
+    // Threads running the random enq/deq mix; ignored when roles are given.
+    size_t threads = 4;
+    // Dedicated roles: producers only enqueue, consumers only dequeue.
+    size_t producers = 0;
+    size_t consumers = 0;
+    size_t ops_per_thread = 1000000;
+    int enq_probability = 50;
+    // Zero runs every schedule once; otherwise schedules repeat until it elapses.
+    std::chrono::milliseconds duration{0};
+    uint32_t seed = 1;
+};
+
+struct BenchResult {
+    double elapsed_ms;
+    uint64_t enqueues;
+    uint64_t dequeues;
+    uint64_t empty_dequeues;
+
+    // Every operation attempted, empty dequeues included, as the drivers counted
+    // before the harness; emptyFraction() reports the empty ones on their own.
+    uint64_t operations() const { return enqueues + dequeues + empty_dequeues; }
+
+    double throughput() const {
+        return operations() / (elapsed_ms / 1000.0);
+    }
+
+    double emptyFraction() const {
+        return operations() ? static_cast<double>(empty_dequeues) / operations() : 0.0;
+    }
+};
+
+inline bool hasRoles(const BenchConfig& config) {
+    return config.producers + config.consumers > 0;
+}
+
+inline size_t benchThreadCount(const BenchConfig& config) {
+    return hasRoles(config) ? config.producers + config.consumers : config.threads;
+}
+
+// Values are taken round-robin from values, or drawn from [1, 1000000] when it
+// is empty. With roles, the first config.producers threads are the producers.
+inline std::vector<std::vector<int32_t>> buildSchedules(const BenchConfig& config,
+                                                        const std::vector<uint32_t>& values) {
+    size_t threads = benchThreadCount(config);
+    std::vector<std::vector<int32_t>> schedules(threads);
+    std::mt19937 gen(config.seed);
+    std::uniform_int_distribution<> op_dis(0, 99);
+    std::uniform_int_distribution<int32_t> value_dis(1, 1000000);
+    size_t next_value = 0;
+
+    for (size_t t = 0; t < threads; ++t) {
+        schedules[t].reserve(config.ops_per_thread);
+        for (size_t i = 0; i < config.ops_per_thread; ++i) {
+            bool is_enq = hasRoles(config) ? t < config.producers : op_dis(gen) < config.enq_probability;
+            if (!is_enq) {
+                schedules[t].push_back(BENCH_DEQ);
+            } else if (values.empty()) {
+                schedules[t].push_back(value_dis(gen));
+            } else {
+                schedules[t].push_back(static_cast<int32_t>(values[next_value++ % values.size()] & 0x7FFFFFFF));
+            }
+        }
+    }
+    return schedules;
+}
+
+// Workers check in and spin until the coordinator, having seen all of them,
+// starts the clock and releases them at once.
+class StartBarrier {
+public:
+    StartBarrier() : arrived(0), go(false) {}
+
+    void arriveAndWait() {
+        arrived.fetch_add(1, std::memory_order_acq_rel);
+        for (uint32_t spins = 0; !go.load(std::memory_order_acquire); ++spins) {
+            if (spins % 1024 == 1023) {
+                std::this_thread::yield();
+            } else {
+                cpuRelax();
+            }
+        }
+    }
+
+    void waitForArrivals(size_t count) {
+        while (arrived.load(std::memory_order_acquire) < count) {
+            std::this_thread::yield();
+        }
+    }
+
+    void release() { go.store(true, std::memory_order_release); }
+
+private:
+    std::atomic<size_t> arrived;
+    std::atomic<bool> go;
+};
+
+constexpr size_t BENCH_STOP_CHECK_INTERVAL = 1024;
+
+// enq_fn(int32_t) enqueues; deq_fn() returns whether it got a value.
+template <typename EnqFn, typename DeqFn>
+BenchResult runBenchmark(const BenchConfig& config, const std::vector<std::vector<int32_t>>& schedules,
+                         EnqFn enq_fn, DeqFn deq_fn) {
+    struct alignas(64) Counters {
+        uint64_t enqueues = 0;
+        uint64_t dequeues = 0;
+        uint64_t empty_dequeues = 0;
+    };
+
+    size_t threads = schedules.size();
+    bool timed = config.duration.count() > 0;
+    std::vector<Counters> counters(threads);
+    StartBarrier barrier;
+    std::atomic<bool> stop(false);
+
+    auto worker = [&](size_t t) {
+        const std::vector<int32_t>& ops = schedules[t];
+        Counters local;
+        barrier.arriveAndWait();
+        size_t i = 0;
+        while (!ops.empty()) {
+            size_t end = std::min(i + BENCH_STOP_CHECK_INTERVAL, ops.size());
+            for (; i < end; ++i) {
+                if (ops[i] == BENCH_DEQ) {
+                    if (deq_fn()) {
+                        local.dequeues++;
+                    } else {
+                        local.empty_dequeues++;
+                    }
+                } else {
+                    enq_fn(ops[i]);
+                    local.enqueues++;
+                }
+            }
+            if (i == ops.size()) {
+                if (!timed) break;
+                i = 0;
+            }
+            if (timed && stop.load(std::memory_order_relaxed)) break;
+        }
+        counters[t] = local;
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back(worker, t);
+    }
+    barrier.waitForArrivals(threads);
+    auto start_time = std::chrono::steady_clock::now();
+    barrier.release();
+    if (timed) {
+        std::this_thread::sleep_for(config.duration);
+        stop.store(true, std::memory_order_relaxed);
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+
+    BenchResult result = {std::chrono::duration<double, std::milli>(elapsed).count(), 0, 0, 0};
+    for (const Counters& c : counters) {
+        result.enqueues += c.enqueues;
+        result.dequeues += c.dequeues;
+        result.empty_dequeues += c.empty_dequeues;
+    }
+    return result;
+}
+
+// Log-linear histogram of nanosecond latencies. Values below 2^SUB_BITS are
+// exact; each power of two above that is split into 2^SUB_BITS buckets, so a
+// reported percentile is within about 3% of the true value. Not thread-safe:
+// keep one per recording thread and merge afterwards.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram() : counts(BUCKETS, 0), total(0), max_ns(0) {}
+
+    void record(uint64_t ns) {
+        counts[bucketOf(ns)]++;
+        total++;
+        max_ns = std::max(max_ns, ns);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        max_ns = std::max(max_ns, other.max_ns);
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return max_ns; }
+
+    // Upper edge of the bucket holding the p-th percentile, p in [0, 100].
+    uint64_t percentile(double p) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(p / 100.0 * total);
+        if (target == 0) {
+            target = 1;
+        }
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= target) {
+                return std::min(bucketUpper(i), max_ns);
+            }
+        }
+        return max_ns;
+    }
+
+private:
+    static size_t bucketOf(uint64_t v) {
+        if (v < SUB_BUCKETS) {
+            return static_cast<size_t>(v);
+        }
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - SUB_BITS;
+        size_t sub = static_cast<size_t>(v >> shift) & (SUB_BUCKETS - 1);
+        return static_cast<size_t>(shift + 1) * SUB_BUCKETS + sub;
+    }
+
+    static uint64_t bucketUpper(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+        uint64_t sub = index % SUB_BUCKETS;
+        uint64_t lower = ((SUB_BUCKETS | sub) << shift);
+        return lower + (uint64_t(1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts;
+    uint64_t total;
+    uint64_t max_ns;
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+// Fixed-capacity MPMC ring after Vyukov. Each cell carries a sequence number that
+// says whose turn it is: sequence == pos means free for the enqueuer holding
+// ticket pos, sequence == pos + 1 means filled for the dequeuer holding ticket pos.
+// Nothing is allocated after creation, and a full ring fails try_enqueue instead
+// of growing.
+template <typename T>
+struct BoundedQueue {
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* payload() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    Cell* cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enq_pos;
+    alignas(64) std::atomic<size_t> deq_pos;
+};
+
+// Capacity is rounded up to a power of two.
+template <typename T>
+BoundedQueue<T>* createBoundedQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    BoundedQueue<T>* q = new BoundedQueue<T>();
+    q->cells = new typename BoundedQueue<T>::Cell[size];
+    q->mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        q->cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    q->enq_pos.store(0, std::memory_order_relaxed);
+    q->deq_pos.store(0, std::memory_order_relaxed);
+    return q;
+}
+
+// Not safe against concurrent use; payloads still queued are destroyed in place.
+template <typename T>
+void deleteBoundedQueue(BoundedQueue<T>* q) {
+    size_t pos = q->deq_pos.load(std::memory_order_relaxed);
+    size_t end = q->enq_pos.load(std::memory_order_relaxed);
+    for (; pos != end; ++pos) {
+        q->cells[pos & q->mask].payload()->~T();
+    }
+    delete[] q->cells;
+    delete q;
+}
+
+template <typename T>
+size_t capacityOf(const BoundedQueue<T>* q) {
+    return q->mask + 1;
+}
+
+template <typename T, typename... Args>
+bool try_enqueue(BoundedQueue<T>* q, Args&&... args) {
+    size_t pos = q->enq_pos.load(std::memory_order_relaxed);
+    while (true) {
+        typename BoundedQueue<T>::Cell& cell = q->cells[pos & q->mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (q->enq_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                new (cell.storage) T(std::forward<Args>(args)...);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = q->enq_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+bool try_dequeue(BoundedQueue<T>* q, T& out) {
+    size_t pos = q->deq_pos.load(std::memory_order_relaxed);
+    while (true) {
+        typename BoundedQueue<T>::Cell& cell = q->cells[pos & q->mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (q->deq_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                out = std::move(*cell.payload());
+                cell.payload()->~T();
+                cell.sequence.store(pos + q->mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = q->deq_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Claims as many consecutive free cells as are ready (up to n) with one CAS on
+// enq_pos and returns how many values were enqueued; 0 means the ring is full.
+template <typename T>
+size_t try_enqueue_bulk(BoundedQueue<T>* q, const T* values, size_t n) {
+    size_t pos = q->enq_pos.load(std::memory_order_relaxed);
+    while (true) {
+        size_t ready = 0;
+        while (ready < n &&
+               q->cells[(pos + ready) & q->mask].sequence.load(std::memory_order_acquire) == pos + ready) {
+            ready++;
+        }
+        if (ready == 0) {
+            size_t sequence = q->cells[pos & q->mask].sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos) < 0) {
+                return 0;
+            }
+            pos = q->enq_pos.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        // A cell seen free for ticket pos + i stays free until that ticket's
+        // owner fills it, and the CAS below makes this thread that owner.
+        if (q->enq_pos.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+            for (size_t i = 0; i < ready; ++i) {
+                typename BoundedQueue<T>::Cell& cell = q->cells[(pos + i) & q->mask];
+                new (cell.storage) T(values[i]);
+                cell.sequence.store(pos + i + 1, std::memory_order_release);
+            }
+            return ready;
+        }
+    }
+}
+
+template <typename T>
+size_t try_dequeue_bulk(BoundedQueue<T>* q, T* out, size_t max) {
+    size_t pos = q->deq_pos.load(std::memory_order_relaxed);
+    while (true) {
+        size_t ready = 0;
+        while (ready < max &&
+               q->cells[(pos + ready) & q->mask].sequence.load(std::memory_order_acquire) == pos + ready + 1) {
+            ready++;
+        }
+        if (ready == 0) {
+            size_t sequence = q->cells[pos & q->mask].sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0) {
+                return 0;
+            }
+            pos = q->deq_pos.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (q->deq_pos.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+            for (size_t i = 0; i < ready; ++i) {
+                typename BoundedQueue<T>::Cell& cell = q->cells[(pos + i) & q->mask];
+                out[i] = std::move(*cell.payload());
+                cell.payload()->~T();
+                cell.sequence.store(pos + i + q->mask + 1, std::memory_order_release);
+            }
+            return ready;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef COUNTED_PTR_H
+#define COUNTED_PTR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+struct NodeLink;
+
+// The count is pointer-width so the struct has no padding: the 16-byte CAS
+// compares raw bytes, and garbage in a pad word makes it fail spuriously.
+struct WideCountedPtr {
+    NodeLink* ptr;
+    uintptr_t count;
+};
+
+// User-space pointers on x86-64 and AArch64 fit in 48 bits, which leaves the top
+// 16 bits for the ABA counter and lets the whole thing go through a 64-bit CAS.
+struct PackedCountedPtr {
+    uint64_t bits;
+
+    static constexpr int PTR_BITS = 48;
+    static constexpr uint64_t PTR_MASK = (1ULL << PTR_BITS) - 1;
+};
+
+inline NodeLink* ptr_of(WideCountedPtr p) { return p.ptr; }
+inline unsigned int count_of(WideCountedPtr p) { return static_cast<unsigned int>(p.count); }
+
+inline NodeLink* ptr_of(PackedCountedPtr p) {
+    return reinterpret_cast<NodeLink*>(static_cast<int64_t>(p.bits << 16) >> 16);
+}
+inline unsigned int count_of(PackedCountedPtr p) {
+    return static_cast<unsigned int>(p.bits >> PackedCountedPtr::PTR_BITS);
+}
+
+template <typename P> P make_counted(NodeLink* ptr, unsigned int count);
+
+template <> inline WideCountedPtr make_counted<WideCountedPtr>(NodeLink* ptr, unsigned int count) {
+    return {ptr, count};
+}
+
+template <> inline PackedCountedPtr make_counted<PackedCountedPtr>(NodeLink* ptr, unsigned int count) {
+    return {(reinterpret_cast<uint64_t>(ptr) & PackedCountedPtr::PTR_MASK) |
+            (static_cast<uint64_t>(count & 0xFFFF) << PackedCountedPtr::PTR_BITS)};
+}
+
+inline bool operator==(const WideCountedPtr &lhs, const WideCountedPtr &rhs) {
+    return lhs.ptr == rhs.ptr && lhs.count == rhs.count;
+}
+
+inline bool operator==(const PackedCountedPtr &lhs, const PackedCountedPtr &rhs) {
+    return lhs.bits == rhs.bits;
+}
+
+static_assert(std::is_trivial<WideCountedPtr>::value, "WideCountedPtr must be a trivial type");
+static_assert(std::is_trivial<PackedCountedPtr>::value, "PackedCountedPtr must be a trivial type");
+static_assert(sizeof(WideCountedPtr) == 2 * sizeof(void*), "WideCountedPtr must not contain padding");
+static_assert(sizeof(PackedCountedPtr) == 8 && sizeof(void*) == 8, "PackedCountedPtr needs 64-bit pointers");
+
+#ifdef MSQUEUE_PACKED_PTR
+typedef PackedCountedPtr CountedNodePtr;
+#else
+typedef WideCountedPtr CountedNodePtr;
+#endif
+
+// The part of a queue node the algorithm, the pool and the free list touch;
+// the payload lives in the typed node that derives from it.
+struct NodeLink {
+    std::atomic<CountedNodePtr> next;
+
+    NodeLink() {
+        next.store(make_counted<CountedNodePtr>(nullptr, 0), std::memory_order_relaxed);
+    }
+};
+
+// Every rewrite of a node's next bumps its tag, so a stale CAS from a thread
+// that last saw the node somewhere else cannot succeed after the node is reused.
+inline void relinkNode(NodeLink* node, NodeLink* target) {
+    CountedNodePtr old = node->next.load(std::memory_order_relaxed);
+    node->next.store(make_counted<CountedNodePtr>(target, count_of(old) + 1), std::memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef CPU_RELAX_H
+#define CPU_RELAX_H
+
+// Spin-loop hint: lets the sibling hyperthread run and avoids the memory-order
+// mis-speculation penalty when the loop finally exits.
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    asm volatile("" ::: "memory");
+#endif
+}
+
+#endif
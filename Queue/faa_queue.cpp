@@ -0,0 +1,161 @@
+#include "faa_queue.h"
+
+// A cell holds 0 until an enqueuer fills it and TAKEN once a dequeuer has
+// visited it. Values carry a marker bit so that 0 and -1 are ordinary payloads.
+static constexpr uint64_t EMPTY = 0;
+static constexpr uint64_t TAKEN = ~0ULL;
+static constexpr uint64_t FILLED = 1ULL << 32;
+
+static uint64_t encode(int value) {
+    return FILLED | static_cast<uint32_t>(value);
+}
+
+static int decode(uint64_t cell) {
+    return static_cast<int>(static_cast<uint32_t>(cell));
+}
+
+FAASegment::FAASegment() {
+    deq_index.store(0, std::memory_order_relaxed);
+    enq_index.store(0, std::memory_order_relaxed);
+    next.store(nullptr, std::memory_order_relaxed);
+    for (size_t i = 0; i < CELLS; ++i) {
+        cells[i].store(EMPTY, std::memory_order_relaxed);
+    }
+}
+
+static void reclaimSegment(void*, void* ptr) {
+    delete static_cast<FAASegment*>(ptr);
+}
+
+static FAASegment* protect(HazardDomain::Record* rec, const std::atomic<FAASegment*>& src) {
+    FAASegment* snapshot = src.load(std::memory_order_acquire);
+    while (true) {
+        HazardDomain::protect(rec, 0, snapshot);
+        FAASegment* current = src.load(std::memory_order_acquire);
+        if (current == snapshot) {
+            return snapshot;
+        }
+        snapshot = current;
+    }
+}
+
+bool enq(FAAQueue* q, int value) {
+    HazardDomain::Record* rec = q->hazards->record();
+    uint64_t item = encode(value);
+
+    while (true) {
+        FAASegment* tail = protect(rec, q->tail);
+        uint64_t index = tail->enq_index.fetch_add(1, std::memory_order_acq_rel);
+
+        if (index < FAASegment::CELLS) {
+            uint64_t expected = EMPTY;
+            if (tail->cells[index].compare_exchange_strong(expected, item,
+                                                           std::memory_order_release,
+                                                           std::memory_order_relaxed)) {
+                HazardDomain::clear(rec);
+                return true;
+            }
+            // A dequeuer got to this cell first and poisoned it; take another.
+            continue;
+        }
+
+        if (tail != q->tail.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        FAASegment* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            FAASegment* segment = new FAASegment();
+            segment->cells[0].store(item, std::memory_order_relaxed);
+            segment->enq_index.store(1, std::memory_order_relaxed);
+            if (tail->next.compare_exchange_strong(next, segment,
+                                                   std::memory_order_release,
+                                                   std::memory_order_acquire)) {
+                q->tail.compare_exchange_strong(tail, segment,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed);
+                HazardDomain::clear(rec);
+                return true;
+            }
+            delete segment;
+        } else {
+            q->tail.compare_exchange_strong(tail, next,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed);
+        }
+    }
+}
+
+bool try_dequeue(FAAQueue* q, int& out) {
+    HazardDomain::Record* rec = q->hazards->record();
+
+    while (true) {
+        FAASegment* head = protect(rec, q->head);
+        if (head->deq_index.load(std::memory_order_acquire) >= head->enq_index.load(std::memory_order_acquire) &&
+            head->next.load(std::memory_order_acquire) == nullptr) {
+            break;
+        }
+
+        uint64_t index = head->deq_index.fetch_add(1, std::memory_order_acq_rel);
+        if (index >= FAASegment::CELLS) {
+            FAASegment* next = head->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                break;
+            }
+            // Never let head pass a lagging tail, or the tail would point at a
+            // retired segment.
+            FAASegment* tail = head;
+            q->tail.compare_exchange_strong(tail, next,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed);
+            if (q->head.compare_exchange_strong(head, next,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+                HazardDomain::clear(rec);
+                q->hazards->retire(rec, head);
+            }
+            continue;
+        }
+
+        uint64_t item = head->cells[index].exchange(TAKEN, std::memory_order_acq_rel);
+        if (item == EMPTY) {
+            continue;
+        }
+
+        HazardDomain::clear(rec);
+        out = decode(item);
+        return true;
+    }
+
+    HazardDomain::clear(rec);
+    return false;
+}
+
+int deq(FAAQueue* q) {
+    int value;
+    return try_dequeue(q, value) ? value : -1;
+}
+
+FAAQueue* createFAAQueue(size_t reclaim_threshold) {
+    FAAQueue* q = new FAAQueue();
+    q->hazards = new HazardDomain(reclaim_threshold, reclaimSegment, q);
+
+    FAASegment* segment = new FAASegment();
+    q->head.store(segment, std::memory_order_relaxed);
+    q->tail.store(segment, std::memory_order_relaxed);
+
+    return q;
+}
+
+void deleteFAAQueue(FAAQueue* q) {
+    delete q->hazards;
+
+    FAASegment* segment = q->head.load(std::memory_order_relaxed);
+    while (segment != nullptr) {
+        FAASegment* next = segment->next.load(std::memory_order_relaxed);
+        delete segment;
+        segment = next;
+    }
+
+    delete q;
+}
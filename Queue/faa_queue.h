@@ -0,0 +1,39 @@
+#ifndef FAA_QUEUE_H
+#define FAA_QUEUE_H
+
+#include "hazard_pointers.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Unbounded MPMC queue over a linked list of fixed-size segments. Enqueuers and
+// dequeuers each claim a cell with one fetch-and-add on the segment's index, so
+// contention turns into FAA traffic instead of failed CAS retries on head/tail.
+// Only the rare move to the next segment needs a CAS.
+struct FAASegment {
+    static constexpr size_t CELLS = 1024;
+
+    alignas(64) std::atomic<uint64_t> deq_index;
+    alignas(64) std::atomic<uint64_t> enq_index;
+    alignas(64) std::atomic<FAASegment*> next;
+    std::atomic<uint64_t> cells[CELLS];
+
+    FAASegment();
+};
+
+struct FAAQueue {
+    alignas(64) std::atomic<FAASegment*> head;
+    alignas(64) std::atomic<FAASegment*> tail;
+    HazardDomain* hazards;
+};
+
+bool enq(FAAQueue* q, int value);
+bool try_dequeue(FAAQueue* q, int& out);
+int deq(FAAQueue* q);
+
+// Segments retire once per CELLS dequeues, so a small threshold keeps the
+// retired backlog (8 KiB per segment) bounded.
+FAAQueue* createFAAQueue(size_t reclaim_threshold = 8);
+void deleteFAAQueue(FAAQueue* q);
+
+#endif
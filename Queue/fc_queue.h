@@ -0,0 +1,192 @@
+#ifndef FC_QUEUE_H
+#define FC_QUEUE_H
+
+#include "cpu_relax.h"
+#include "thread_registry.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+// Flat-combining queue. A thread publishes its operation in its own record and
+// spins; whoever grabs the combiner lock scans every record and applies all
+// pending operations to a plain ring buffer, so under heavy contention one thread
+// works on hot, uncontended cache lines instead of everyone retrying a CAS.
+template <typename T>
+struct FCQueue {
+    enum Op : uint32_t { IDLE, ENQ, DEQ, DONE };
+
+    // One per thread slot. arg points at the caller's value (ENQ) or output (DEQ)
+    // and stays valid because the caller waits for DONE.
+    struct alignas(64) Record {
+        std::atomic<uint32_t> op;
+        bool result;
+        T* arg;
+    };
+
+    Record records[MAX_THREADS];
+    std::atomic<size_t> active_records;
+
+    // Touched only by the thread holding combiner_lock.
+    alignas(64) std::atomic<bool> combiner_lock;
+    unsigned char* buffer;
+    size_t capacity;
+    size_t head;
+    size_t tail;
+
+    T* slotAt(size_t pos) {
+        return std::launder(reinterpret_cast<T*>(buffer + (pos & (capacity - 1)) * sizeof(T)));
+    }
+};
+
+template <typename T>
+FCQueue<T>* createFCQueue(size_t initial_capacity = 1024) {
+    size_t size = 2;
+    while (size < initial_capacity) {
+        size <<= 1;
+    }
+
+    FCQueue<T>* q = new FCQueue<T>();
+    for (size_t i = 0; i < MAX_THREADS; ++i) {
+        q->records[i].op.store(FCQueue<T>::IDLE, std::memory_order_relaxed);
+    }
+    q->active_records.store(0, std::memory_order_relaxed);
+    q->combiner_lock.store(false, std::memory_order_relaxed);
+    q->buffer = static_cast<unsigned char*>(::operator new(size * sizeof(T), std::align_val_t(alignof(T))));
+    q->capacity = size;
+    q->head = 0;
+    q->tail = 0;
+    return q;
+}
+
+// Not safe against concurrent use; payloads still queued are destroyed in place.
+template <typename T>
+void deleteFCQueue(FCQueue<T>* q) {
+    for (size_t pos = q->head; pos != q->tail; ++pos) {
+        q->slotAt(pos)->~T();
+    }
+    ::operator delete(q->buffer, std::align_val_t(alignof(T)));
+    delete q;
+}
+
+// Doubles the ring, moving the live range to the front of the new buffer.
+template <typename T>
+void growFCBuffer(FCQueue<T>* q) {
+    size_t size = q->capacity * 2;
+    unsigned char* buffer = static_cast<unsigned char*>(::operator new(size * sizeof(T), std::align_val_t(alignof(T))));
+    size_t count = q->tail - q->head;
+    for (size_t i = 0; i < count; ++i) {
+        T* item = q->slotAt(q->head + i);
+        new (buffer + i * sizeof(T)) T(std::move(*item));
+        item->~T();
+    }
+    ::operator delete(q->buffer, std::align_val_t(alignof(T)));
+    q->buffer = buffer;
+    q->capacity = size;
+    q->head = 0;
+    q->tail = count;
+}
+
+constexpr int FC_COMBINE_PASSES = 3;
+
+// Runs with combiner_lock held. Rescans while passes keep finding work, so
+// requests published during a pass are served without another lock handoff.
+template <typename T>
+void combineFC(FCQueue<T>* q) {
+    size_t active = q->active_records.load(std::memory_order_acquire);
+    for (int pass = 0; pass < FC_COMBINE_PASSES; ++pass) {
+        bool found = false;
+        for (size_t i = 0; i < active; ++i) {
+            typename FCQueue<T>::Record& rec = q->records[i];
+            uint32_t op = rec.op.load(std::memory_order_acquire);
+            if (op == FCQueue<T>::ENQ) {
+                if (q->tail - q->head == q->capacity) {
+                    growFCBuffer(q);
+                }
+                new (q->buffer + (q->tail & (q->capacity - 1)) * sizeof(T)) T(std::move(*rec.arg));
+                q->tail++;
+                rec.result = true;
+            } else if (op == FCQueue<T>::DEQ) {
+                if (q->head == q->tail) {
+                    rec.result = false;
+                } else {
+                    T* item = q->slotAt(q->head);
+                    *rec.arg = std::move(*item);
+                    item->~T();
+                    q->head++;
+                    rec.result = true;
+                }
+            } else {
+                continue;
+            }
+            rec.op.store(FCQueue<T>::DONE, std::memory_order_release);
+            found = true;
+        }
+        if (!found) {
+            break;
+        }
+    }
+}
+
+// Publishes op on the caller's record and waits until some combiner, possibly
+// this thread, has applied it.
+template <typename T>
+bool applyFC(FCQueue<T>* q, uint32_t op, T* arg) {
+    size_t slot = currentThreadSlot();
+    size_t active = q->active_records.load(std::memory_order_relaxed);
+    while (active <= slot &&
+           !q->active_records.compare_exchange_weak(active, slot + 1, std::memory_order_release,
+                                                    std::memory_order_relaxed)) {
+    }
+
+    typename FCQueue<T>::Record& rec = q->records[slot];
+    rec.arg = arg;
+    rec.op.store(op, std::memory_order_release);
+    while (rec.op.load(std::memory_order_acquire) != FCQueue<T>::DONE) {
+        if (!q->combiner_lock.load(std::memory_order_relaxed) &&
+            !q->combiner_lock.exchange(true, std::memory_order_acquire)) {
+            combineFC(q);
+            q->combiner_lock.store(false, std::memory_order_release);
+        } else {
+            cpuRelax();
+        }
+    }
+    bool result = rec.result;
+    rec.op.store(FCQueue<T>::IDLE, std::memory_order_relaxed);
+    return result;
+}
+
+template <typename T, typename... Args>
+bool enq(FCQueue<T>* q, Args&&... args) {
+    T value(std::forward<Args>(args)...);
+    return applyFC(q, FCQueue<T>::ENQ, &value);
+}
+
+template <typename T, typename... Args>
+bool try_enqueue(FCQueue<T>* q, Args&&... args) {
+    return enq(q, std::forward<Args>(args)...);
+}
+
+template <typename T>
+bool try_dequeue(FCQueue<T>* q, T& out) {
+    return applyFC(q, FCQueue<T>::DEQ, &out);
+}
+
+inline int deq(FCQueue<int>* q) {
+    int value;
+    return try_dequeue(q, value) ? value : -1;
+}
+
+// Takes the combiner lock, so the count is exact but stalls other threads' work.
+template <typename T>
+int countQueue(FCQueue<T>* q) {
+    while (q->combiner_lock.exchange(true, std::memory_order_acquire)) {
+        cpuRelax();
+    }
+    int count = static_cast<int>(q->tail - q->head);
+    q->combiner_lock.store(false, std::memory_order_release);
+    return count;
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include "hazard_pointers.h"
+#include <algorithm>
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static bool registerMembarrier() {
+    long supported = syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0, 0);
+    if (supported < 0 || !(supported & MEMBARRIER_CMD_PRIVATE_EXPEDITED)) {
+        return false;
+    }
+    return syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+}
+
+bool hazard_asymmetric_fences = registerMembarrier();
+
+void asymmetricHeavyFence() {
+    if (hazard_asymmetric_fences) {
+        syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+    } else {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+HazardDomain::HazardDomain(size_t reclaim_threshold, Reclaimer reclaim, void* ctx)
+    : threshold(std::max<size_t>(1, reclaim_threshold)), reclaimer(reclaim), reclaim_ctx(ctx),
+      high_water(0), retired_count(0), reclaimed_count(0)
+{
+    for (size_t i = 0; i < MAX_THREADS; ++i) {
+        records[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+HazardDomain::~HazardDomain() {
+    for (size_t i = 0; i < MAX_THREADS; ++i) {
+        Record* rec = records[i].load(std::memory_order_relaxed);
+        if (!rec) continue;
+        for (void* ptr : rec->retired) {
+            reclaimer(reclaim_ctx, ptr);
+        }
+        delete rec;
+    }
+}
+
+HazardDomain::Record* HazardDomain::record() {
+    size_t slot = currentThreadSlot();
+    Record* rec = records[slot].load(std::memory_order_acquire);
+    if (rec) {
+        return rec;
+    }
+    
+    rec = new Record();
+    for (size_t i = 0; i < SLOTS_PER_THREAD; ++i) {
+        rec->hazard[i].store(nullptr, std::memory_order_relaxed);
+    }
+    rec->retired.reserve(threshold);
+    records[slot].store(rec, std::memory_order_release);
+    
+    size_t seen = high_water.load(std::memory_order_relaxed);
+    while (seen < slot + 1 &&
+           !high_water.compare_exchange_weak(seen, slot + 1, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+    }
+    return rec;
+}
+
+void HazardDomain::retire(Record* rec, void* ptr) {
+    rec->retired.push_back(ptr);
+    retired_count.fetch_add(1, std::memory_order_relaxed);
+    if (rec->retired.size() >= threshold) {
+        scan(rec);
+    }
+}
+
+void HazardDomain::scan(Record* rec) {
+    asymmetricHeavyFence();
+    
+    std::vector<void*>& hazards = rec->scratch;
+    hazards.clear();
+    size_t limit = high_water.load(std::memory_order_acquire);
+    for (size_t i = 0; i < limit; ++i) {
+        Record* other = records[i].load(std::memory_order_acquire);
+        if (!other) continue;
+        for (size_t j = 0; j < SLOTS_PER_THREAD; ++j) {
+            void* ptr = other->hazard[j].load(std::memory_order_acquire);
+            if (ptr) hazards.push_back(ptr);
+        }
+    }
+    std::sort(hazards.begin(), hazards.end());
+    
+    size_t kept = 0;
+    for (void* ptr : rec->retired) {
+        if (std::binary_search(hazards.begin(), hazards.end(), ptr)) {
+            rec->retired[kept++] = ptr;
+        } else {
+            reclaimer(reclaim_ctx, ptr);
+        }
+    }
+    
+    size_t freed = rec->retired.size() - kept;
+    rec->retired.resize(kept);
+    retired_count.fetch_sub(freed, std::memory_order_relaxed);
+    reclaimed_count.fetch_add(freed, std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+#ifndef HAZARD_POINTERS_H
+#define HAZARD_POINTERS_H
+
+#include "thread_registry.h"
+#include <atomic>
+#include <vector>
+
+// Set at startup when membarrier(2) is available: protect() then only needs a
+// compiler barrier and scan() pays for one process-wide barrier instead.
+extern bool hazard_asymmetric_fences;
+
+// The cheap side of a Dekker-style handshake: a compiler barrier when the other
+// side issues asymmetricHeavyFence(), a full fence otherwise.
+inline void asymmetricLightFence() {
+    if (hazard_asymmetric_fences) {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    } else {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+void asymmetricHeavyFence();
+
+class HazardDomain {
+public:
+    static constexpr size_t SLOTS_PER_THREAD = 2;
+    typedef void (*Reclaimer)(void* ctx, void* ptr);
+
+    struct alignas(64) Record {
+        std::atomic<void*> hazard[SLOTS_PER_THREAD];
+        std::vector<void*> retired;
+        std::vector<void*> scratch;
+    };
+
+    HazardDomain(size_t reclaim_threshold, Reclaimer reclaim, void* ctx);
+    ~HazardDomain();
+
+    Record* record();
+
+    // The caller must re-read the source after protect() and retry if it changed.
+    static void protect(Record* rec, size_t index, void* ptr) {
+        rec->hazard[index].store(ptr, std::memory_order_relaxed);
+        asymmetricLightFence();
+    }
+
+    static void clear(Record* rec) {
+        for (size_t i = 0; i < SLOTS_PER_THREAD; ++i) {
+            rec->hazard[i].store(nullptr, std::memory_order_release);
+        }
+    }
+
+    void retire(Record* rec, void* ptr);
+
+    size_t pending() const { return retired_count.load(std::memory_order_relaxed); }
+    size_t reclaimed() const { return reclaimed_count.load(std::memory_order_relaxed); }
+
+private:
+    void scan(Record* rec);
+
+    size_t threshold;
+    Reclaimer reclaimer;
+    void* reclaim_ctx;
+
+    std::atomic<Record*> records[MAX_THREADS];
+    std::atomic<size_t> high_water;
+    std::atomic<size_t> retired_count;
+    std::atomic<size_t> reclaimed_count;
+};
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef LOCK_QUEUE_H
+#define LOCK_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+// Lock-based baselines with the same enq/try_dequeue/deq/countQueue API as
+// MSQueue, so benchmarks can show what the lock-free designs buy.
+
+// Michael and Scott's two-lock queue: a linked list with a dummy head node,
+// one lock for enqueuers at the tail and one for dequeuers at the head, so a
+// producer and a consumer never wait on each other. With one element left they
+// still meet on the dummy's next pointer, which is therefore atomic.
+template <typename T>
+struct TwoLockQueue {
+    struct Node {
+        std::atomic<Node*> next;
+        T value;
+    };
+
+    alignas(64) std::mutex head_lock;
+    Node* head;
+    alignas(64) std::mutex tail_lock;
+    Node* tail;
+};
+
+template <typename T>
+TwoLockQueue<T>* createTwoLockQueue() {
+    TwoLockQueue<T>* q = new TwoLockQueue<T>();
+    typename TwoLockQueue<T>::Node* dummy = new typename TwoLockQueue<T>::Node();
+    dummy->next.store(nullptr, std::memory_order_relaxed);
+    q->head = dummy;
+    q->tail = dummy;
+    return q;
+}
+
+// Not safe against concurrent use.
+template <typename T>
+void deleteTwoLockQueue(TwoLockQueue<T>* q) {
+    while (q->head) {
+        typename TwoLockQueue<T>::Node* next = q->head->next.load(std::memory_order_relaxed);
+        delete q->head;
+        q->head = next;
+    }
+    delete q;
+}
+
+template <typename T, typename... Args>
+bool enq(TwoLockQueue<T>* q, Args&&... args) {
+    typename TwoLockQueue<T>::Node* node =
+        new typename TwoLockQueue<T>::Node{{nullptr}, T(std::forward<Args>(args)...)};
+    std::lock_guard<std::mutex> guard(q->tail_lock);
+    q->tail->next.store(node, std::memory_order_release);
+    q->tail = node;
+    return true;
+}
+
+// The value is moved out of the new head, which then becomes the dummy; only
+// the old dummy is freed, outside the lock.
+template <typename T>
+bool try_dequeue(TwoLockQueue<T>* q, T& out) {
+    typename TwoLockQueue<T>::Node* old_head;
+    {
+        std::lock_guard<std::mutex> guard(q->head_lock);
+        old_head = q->head;
+        typename TwoLockQueue<T>::Node* next = old_head->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        out = std::move(next->value);
+        q->head = next;
+    }
+    delete old_head;
+    return true;
+}
+
+inline int deq(TwoLockQueue<int>* q) {
+    int value;
+    return try_dequeue(q, value) ? value : -1;
+}
+
+// Holds both locks while it walks the list.
+template <typename T>
+int countQueue(TwoLockQueue<T>* q) {
+    std::scoped_lock guard(q->head_lock, q->tail_lock);
+    int count = 0;
+    for (typename TwoLockQueue<T>::Node* node = q->head->next.load(std::memory_order_acquire); node;
+         node = node->next.load(std::memory_order_acquire)) {
+        count++;
+    }
+    return count;
+}
+
+// The simplest possible queue: one std::mutex around a std::deque.
+template <typename T>
+struct MutexQueue {
+    std::mutex lock;
+    std::deque<T> items;
+};
+
+template <typename T>
+MutexQueue<T>* createMutexQueue() {
+    return new MutexQueue<T>();
+}
+
+template <typename T>
+void deleteMutexQueue(MutexQueue<T>* q) {
+    delete q;
+}
+
+template <typename T, typename... Args>
+bool enq(MutexQueue<T>* q, Args&&... args) {
+    std::lock_guard<std::mutex> guard(q->lock);
+    q->items.emplace_back(std::forward<Args>(args)...);
+    return true;
+}
+
+template <typename T>
+bool try_dequeue(MutexQueue<T>* q, T& out) {
+    std::lock_guard<std::mutex> guard(q->lock);
+    if (q->items.empty()) {
+        return false;
+    }
+    out = std::move(q->items.front());
+    q->items.pop_front();
+    return true;
+}
+
+inline int deq(MutexQueue<int>* q) {
+    int value;
+    return try_dequeue(q, value) ? value : -1;
+}
+
+template <typename T>
+int countQueue(MutexQueue<T>* q) {
+    std::lock_guard<std::mutex> guard(q->lock);
+    return static_cast<int>(q->items.size());
+}
+
+#endif
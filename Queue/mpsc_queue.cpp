@@ -0,0 +1,46 @@
+#include "mpsc_queue.h"
+
+void initMPSCQueue(MPSCIntrusiveQueue* q) {
+    q->stub.next.store(nullptr, std::memory_order_relaxed);
+    q->head.store(&q->stub, std::memory_order_relaxed);
+    q->tail = &q->stub;
+}
+
+void mpscPush(MPSCIntrusiveQueue* q, MPSCLink* link) {
+    link->next.store(nullptr, std::memory_order_relaxed);
+    MPSCLink* prev = q->head.exchange(link, std::memory_order_acq_rel);
+    prev->next.store(link, std::memory_order_release);
+}
+
+MPSCLink* mpscPop(MPSCIntrusiveQueue* q) {
+    MPSCLink* tail = q->tail;
+    MPSCLink* next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &q->stub) {
+        if (next == nullptr) {
+            return nullptr;
+        }
+        q->tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr) {
+        q->tail = next;
+        return tail;
+    }
+
+    // tail is the last linked node. Unless a producer is mid-push, re-insert the
+    // stub behind it so tail can be handed out without leaving the list empty.
+    if (tail != q->head.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    mpscPush(q, &q->stub);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        q->tail = next;
+        return tail;
+    }
+    return nullptr;
+}
@@ -0,0 +1,79 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// Intrusive multi-producer single-consumer queue after Vyukov. Producers publish
+// with one exchange on head and then link the previous node; the consumer walks
+// from tail with plain loads and never contends with them. Objects embed an
+// MPSCLink and are handed over without any allocation by the queue itself.
+struct MPSCLink {
+    std::atomic<MPSCLink*> next;
+};
+
+struct MPSCIntrusiveQueue {
+    alignas(64) std::atomic<MPSCLink*> head;
+    alignas(64) MPSCLink* tail;
+    MPSCLink stub;
+};
+
+void initMPSCQueue(MPSCIntrusiveQueue* q);
+// Any thread.
+void mpscPush(MPSCIntrusiveQueue* q, MPSCLink* link);
+// Consumer only. Returns nullptr when empty, and also in the brief window where a
+// producer has swapped head but not yet linked its predecessor.
+MPSCLink* mpscPop(MPSCIntrusiveQueue* q);
+
+// Typed wrapper that boxes each payload in a node carrying the link.
+template <typename T>
+struct MPSCNode : MPSCLink {
+    T value;
+
+    template <typename... Args>
+    explicit MPSCNode(Args&&... args) : value(std::forward<Args>(args)...) {}
+};
+
+template <typename T>
+struct MPSCQueue : MPSCIntrusiveQueue {};
+
+template <typename T>
+MPSCQueue<T>* createMPSCQueue() {
+    MPSCQueue<T>* q = new MPSCQueue<T>();
+    initMPSCQueue(q);
+    return q;
+}
+
+template <typename T, typename... Args>
+bool enq(MPSCQueue<T>* q, Args&&... args) {
+    mpscPush(q, new MPSCNode<T>(std::forward<Args>(args)...));
+    return true;
+}
+
+template <typename T, typename... Args>
+bool try_enqueue(MPSCQueue<T>* q, Args&&... args) {
+    return enq(q, std::forward<Args>(args)...);
+}
+
+template <typename T>
+bool try_dequeue(MPSCQueue<T>* q, T& out) {
+    MPSCLink* link = mpscPop(q);
+    if (link == nullptr) {
+        return false;
+    }
+    MPSCNode<T>* node = static_cast<MPSCNode<T>*>(link);
+    out = std::move(node->value);
+    delete node;
+    return true;
+}
+
+// Not safe against concurrent use.
+template <typename T>
+void deleteMPSCQueue(MPSCQueue<T>* q) {
+    while (MPSCLink* link = mpscPop(q)) {
+        delete static_cast<MPSCNode<T>*>(link);
+    }
+    delete q;
+}
+
+#endif
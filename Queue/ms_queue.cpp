@@ -1,26 +1,63 @@
 #include "ms_queue.h"
+#include <cerrno>
+#include <climits>
+#include <ctime>
 #include <iostream>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
-bool enq(MSQueue* q, int value) {
-    Node* newNode = new Node(value);
+NodeLink* allocNode(MSQueueBase* q) {
+    return q->pool ? q->pool->allocate() : q->create_node();
+}
+
+void freeNode(MSQueueBase* q, NodeLink* node) {
+    if (q->pool) {
+        q->pool->release(node);
+    } else {
+        q->destroy_node(node);
+    }
+}
 
-    CountedNodePtr tail, next, newNext;
+static void reclaimNode(void* ctx, void* ptr) {
+    freeNode(static_cast<MSQueueBase*>(ctx), static_cast<NodeLink*>(ptr));
+}
+
+// Publishes the node src points at in hazard slot index and returns the snapshot
+// once it is known to have been reachable after the hazard became visible.
+CountedNodePtr protectNode(HazardDomain::Record* rec, size_t index,
+                           const std::atomic<CountedNodePtr>& src) {
+    CountedNodePtr snapshot = src.load(std::memory_order_acquire);
     while (true) {
-        tail = q->tail.load(std::memory_order_acquire);
-        next = tail.ptr->next.load(std::memory_order_acquire);
+        HazardDomain::protect(rec, index, ptr_of(snapshot));
+        CountedNodePtr current = src.load(std::memory_order_acquire);
+        if (current == snapshot) {
+            return snapshot;
+        }
+        snapshot = current;
+    }
+}
+
+void appendChain(MSQueueBase* q, NodeLink* first, NodeLink* last, size_t count) {
+    HazardDomain::Record* rec = q->hazards->record();
+    Backoff backoff(q->backoff);
+    uint64_t failures = 0;
+    CountedNodePtr tail, next;
+    while (true) {
+        tail = protectNode(rec, 0, q->tail);
+        next = ptr_of(tail)->next.load(std::memory_order_acquire);
         if (tail == q->tail.load(std::memory_order_acquire)) {
-            if (next.ptr == nullptr) {
-                newNext.ptr = newNode;
-                newNext.count = next.count + 1;
-                if (tail.ptr->next.compare_exchange_weak(next, newNext,
+            if (ptr_of(next) == nullptr) {
+                CountedNodePtr newNext = make_counted<CountedNodePtr>(first, count_of(next) + 1);
+                if (ptr_of(tail)->next.compare_exchange_weak(next, newNext,
                                                        std::memory_order_release,
                                                        std::memory_order_relaxed)) {
                     break;
                 }
+                failures++;
+                backoff.pause();
             } else {
-                CountedNodePtr newTail;
-                newTail.ptr = next.ptr;
-                newTail.count = tail.count + 1;
+                CountedNodePtr newTail = make_counted<CountedNodePtr>(ptr_of(next), count_of(tail) + 1);
                 q->tail.compare_exchange_weak(tail, newTail,
                                            std::memory_order_release,
                                            std::memory_order_relaxed);
@@ -28,115 +65,203 @@ bool enq(MSQueue* q, int value) {
         }
     }
     
-    CountedNodePtr newTail;
-    newTail.ptr = newNode;
-    newTail.count = tail.count + 1;
-    q->tail.compare_exchange_weak(tail, newTail,
-                                std::memory_order_release,
-                                std::memory_order_relaxed);
-    return true;
-}
-
-int deq(MSQueue* q) {
-    CountedNodePtr head, tail, next;
-    while (true) {
-        head = q->head.load(std::memory_order_acquire);
-        tail = q->tail.load(std::memory_order_acquire);
-        next = head.ptr->next.load(std::memory_order_acquire);
-        if (head == q->head.load(std::memory_order_acquire)) {
-            if (head.ptr == tail.ptr) {
-                if (next.ptr == nullptr) {
-                    return -1;
-                }
-                CountedNodePtr newTail;
-                newTail.ptr = next.ptr;
-                newTail.count = tail.count + 1;
-                q->tail.compare_exchange_weak(tail, newTail,
-                                           std::memory_order_release,
-                                           std::memory_order_relaxed);
-            } else {
-                int value = next.ptr->value;
-                CountedNodePtr newHead;
-                newHead.ptr = next.ptr;
-                newHead.count = head.count + 1;
-                if (q->head.compare_exchange_weak(head, newHead,
-                                               std::memory_order_release,
-                                               std::memory_order_relaxed)) {
-                    delete head.ptr;
-                    return value;
-                }
-            }
-        }
-    }
+    // Swing straight to the end of the chain; if a helper already stepped onto it,
+    // later operations finish the walk one node at a time as usual.
+    CountedNodePtr newTail = make_counted<CountedNodePtr>(last, count_of(tail) + 1);
+    q->tail.compare_exchange_strong(tail, newTail,
+                                  std::memory_order_release,
+                                  std::memory_order_relaxed);
+    HazardDomain::clear(rec);
+    recordOp(q, failures + 1, failures, count, 0);
 }
 
-int countQueue(MSQueue* q) {
+int countQueue(MSQueueBase* q) {
     int count = 0;
     CountedNodePtr curr = q->head.load(std::memory_order_relaxed);
-    Node* node = curr.ptr;
+    NodeLink* node = ptr_of(curr);
     
     if (node != nullptr) {
         CountedNodePtr next = node->next.load(std::memory_order_relaxed);
-        node = next.ptr;
+        node = ptr_of(next);
     }
     
     while (node != nullptr) {
         count++;
         CountedNodePtr next = node->next.load(std::memory_order_relaxed);
-        node = next.ptr;
+        node = ptr_of(next);
     }
     
     return count;
 }
 
-void printQueue(MSQueue* q) {
-    CountedNodePtr curr = q->head.load(std::memory_order_acquire);
-    Node* node = curr.ptr;
-    
-    if (node == nullptr) {
-        std::cout << "Queue is empty (dummy head not set).\n";
-        return;
+void initMSQueue(MSQueueBase* q, const MSQueueConfig& config,
+                 NodePool::Creator create, NodePool::Destroyer destroy) {
+    q->create_node = create;
+    q->destroy_node = destroy;
+    q->waiters.store(0, std::memory_order_relaxed);
+    q->wake_seq.store(0, std::memory_order_relaxed);
+    q->spin_budget.store(MIN_DEQUEUE_SPIN, std::memory_order_relaxed);
+    q->async_waiting.store(0, std::memory_order_relaxed);
+    q->async_waiters.store(nullptr, std::memory_order_relaxed);
+    q->async_fenced.store(false, std::memory_order_relaxed);
+    q->match_requests.store(0, std::memory_order_relaxed);
+    q->async_front = nullptr;
+    q->backoff = config.backoff;
+    q->counters = new OpCounters[MAX_THREADS];
+    for (size_t i = 0; i < MAX_THREADS; ++i) {
+        q->counters[i].enqueued.store(0, std::memory_order_relaxed);
+        q->counters[i].dequeued.store(0, std::memory_order_relaxed);
     }
+    resetContentionStats(q);
+    q->pool = config.use_pool ? new NodePool(config.max_pooled_nodes, create, destroy) : nullptr;
+    q->hazards = new HazardDomain(config.reclaim_threshold, reclaimNode, q);
     
-    CountedNodePtr next = node->next.load(std::memory_order_acquire);
+    NodeLink* dummy = allocNode(q);
+    CountedNodePtr init = make_counted<CountedNodePtr>(dummy, 0);
     
-    if (next.ptr == nullptr) {
-        std::cout << "Queue is empty\n";
-        return;
+    q->head.store(init, std::memory_order_relaxed);
+    q->tail.store(init, std::memory_order_relaxed);
+}
+
+void wakeConsumers(MSQueueBase* q, uint32_t count) {
+    q->wake_seq.fetch_add(1, std::memory_order_release);
+    int to_wake = count > INT_MAX ? INT_MAX : static_cast<int>(count);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&q->wake_seq), FUTEX_WAKE_PRIVATE, to_wake, nullptr, nullptr, 0);
+}
+
+bool parkConsumer(MSQueueBase* q, uint32_t seq, const std::chrono::steady_clock::time_point* deadline) {
+    struct timespec timeout;
+    struct timespec* timeout_ptr = nullptr;
+    if (deadline) {
+        auto remaining = *deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero()) {
+            return false;
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+        timeout.tv_sec = ns / 1000000000;
+        timeout.tv_nsec = ns % 1000000000;
+        timeout_ptr = &timeout;
     }
     
-    std::cout << "Queue elements: ";
-    while (next.ptr != nullptr) {
-        std::cout << next.ptr->value << " ";
-        node = next.ptr;
-        next = node->next.load(std::memory_order_acquire);
+    long rc = syscall(SYS_futex, reinterpret_cast<uint32_t*>(&q->wake_seq), FUTEX_WAIT_PRIVATE, seq, timeout_ptr, nullptr, 0);
+    return !(rc == -1 && errno == ETIMEDOUT);
+}
+
+static MSQueue<AsyncWaiter*>* asyncWaiterQueue(MSQueueBase* q) {
+    MSQueue<AsyncWaiter*>* waiters = q->async_waiters.load(std::memory_order_acquire);
+    if (waiters == nullptr) {
+        MSQueue<AsyncWaiter*>* created = createMSQueue<AsyncWaiter*>();
+        if (q->async_waiters.compare_exchange_strong(waiters, created, std::memory_order_acq_rel)) {
+            waiters = created;
+        } else {
+            deleteMSQueue(created);
+        }
     }
-    
-    std::cout << std::endl;
+    return waiters;
 }
 
-MSQueue* createMSQueue() {
-    MSQueue* q = new MSQueue();
-    
-    Node* dummy = new Node(0);
-    CountedNodePtr init;
-    init.ptr = dummy;
-    init.count = 0;
+// Peeks at head->next under a hazard pointer, since head may be retired meanwhile.
+bool queueHasItems(MSQueueBase* q) {
+    HazardDomain::Record* rec = q->hazards->record();
+    CountedNodePtr head = protectNode(rec, 0, q->head);
+    bool has_items = ptr_of(ptr_of(head)->next.load(std::memory_order_acquire)) != nullptr;
+    HazardDomain::clear(rec);
+    return has_items;
+}
+
+// Producers only fence once they see async_waiters set, so until one heavy fence
+// has passed since then a producer may still be skipping it; after that a plain
+// fence on each side is enough.
+bool publishAsyncWaiter(MSQueueBase* q, AsyncWaiter* waiter) {
+    q->async_waiting.fetch_add(1, std::memory_order_relaxed);
+    MSQueue<AsyncWaiter*>* waiters = asyncWaiterQueue(q);
+    if (!q->async_fenced.load(std::memory_order_acquire)) {
+        asymmetricHeavyFence();
+        q->async_fenced.store(true, std::memory_order_release);
+    }
+    enq(waiters, waiter);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return queueHasItems(q);
+}
+
+AsyncWaiter* takeAsyncWaiter(MSQueueBase* q) {
+    AsyncWaiter* waiter = q->async_front;
+    if (waiter != nullptr) {
+        q->async_front = nullptr;
+        return waiter;
+    }
+    MSQueue<AsyncWaiter*>* waiters = q->async_waiters.load(std::memory_order_acquire);
+    if (waiters != nullptr && try_dequeue(waiters, waiter)) {
+        return waiter;
+    }
+    return nullptr;
+}
+
+void returnAsyncWaiter(MSQueueBase* q, AsyncWaiter* waiter) {
+    q->async_front = waiter;
+}
+
+// Payloads are already gone; this only hands the nodes back.
+void destroyMSQueue(MSQueueBase* q) {
+    NodeLink* node = ptr_of(q->head.load(std::memory_order_relaxed));
+    while (node != nullptr) {
+        NodeLink* next = ptr_of(node->next.load(std::memory_order_relaxed));
+        freeNode(q, node);
+        node = next;
+    }
     
-    q->head.store(init, std::memory_order_relaxed);
-    q->tail.store(init, std::memory_order_relaxed);
+    // Coroutines still suspended here are abandoned, as their frames belong to
+    // the caller.
+    MSQueue<AsyncWaiter*>* waiters = q->async_waiters.load(std::memory_order_relaxed);
+    if (waiters != nullptr) {
+        deleteMSQueue(waiters);
+    }
     
-    return q;
+    delete q->hazards;
+    delete q->pool;
+    delete[] q->counters;
 }
 
-void deleteMSQueue(MSQueue* q) {
-    while (deq(q) != -1) {
+ContentionStats contentionStats(const MSQueueBase* q) {
+    ContentionStats stats = {0, 0};
+    for (size_t i = 0; i < MAX_THREADS; ++i) {
+        stats.cas_attempts += q->counters[i].cas_attempts.load(std::memory_order_relaxed);
+        stats.cas_failures += q->counters[i].cas_failures.load(std::memory_order_relaxed);
     }
-    
-    CountedNodePtr head = q->head.load(std::memory_order_relaxed);
-    if (head.ptr != nullptr) {
-        delete head.ptr;
+    return stats;
+}
+
+size_t size_approx(const MSQueueBase* q) {
+    // Counters are bumped just after the winning CAS, so a dequeue can show up
+    // before the enqueue it consumed; the sum is clamped instead of wrapping.
+    uint64_t enqueued = 0;
+    uint64_t dequeued = 0;
+    for (size_t i = 0; i < MAX_THREADS; ++i) {
+        dequeued += q->counters[i].dequeued.load(std::memory_order_relaxed);
+        enqueued += q->counters[i].enqueued.load(std::memory_order_relaxed);
     }
+    return enqueued > dequeued ? static_cast<size_t>(enqueued - dequeued) : 0;
+}
+
+void resetContentionStats(MSQueueBase* q) {
+    for (size_t i = 0; i < MAX_THREADS; ++i) {
+        q->counters[i].cas_attempts.store(0, std::memory_order_relaxed);
+        q->counters[i].cas_failures.store(0, std::memory_order_relaxed);
+    }
+}
+
+void printLockFreeStatus() {
+    std::atomic<WideCountedPtr> wide;
+    std::atomic<PackedCountedPtr> packed;
     
-    delete q;
+    std::cout << "Counted pointer representations:\n";
+    std::cout << "  Wide   {NodeLink*, uintptr_t} (" << sizeof(WideCountedPtr) << " bytes): "
+              << (wide.is_lock_free() ? "lock-free" : "NOT lock-free (libatomic)") << "\n";
+    std::cout << "  Packed 48-bit ptr + 16-bit tag (" << sizeof(PackedCountedPtr) << " bytes): "
+              << (packed.is_lock_free() ? "lock-free" : "NOT lock-free (libatomic)") << "\n";
+#ifdef MSQUEUE_PACKED_PTR
+    std::cout << "  MSQueue is using: Packed\n";
+#else
+    std::cout << "  MSQueue is using: Wide\n";
+#endif
 }
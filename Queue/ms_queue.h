@@ -1,43 +1,535 @@
 #ifndef MS_QUEUE_H
 #define MS_QUEUE_H
 
+#include "counted_ptr.h"
+#include "node_pool.h"
+#include "hazard_pointers.h"
+#include "cpu_relax.h"
+#include "backoff.h"
+#include "thread_registry.h"
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <new>
+#include <optional>
 #include <type_traits>
+#include <utility>
 
+// Small trivially copyable payloads sit in the node as a plain member and are
+// copied out before the head CAS, exactly like the original int queue. Anything
+// else is constructed in place in raw storage and moved out once the CAS is won.
+template <typename T>
+struct InlinePayload : std::integral_constant<bool,
+    std::is_trivially_copyable<T>::value &&
+    std::is_trivially_default_constructible<T>::value &&
+    sizeof(T) <= 2 * sizeof(void*)> {};
+
+template <typename T, bool Inline = InlinePayload<T>::value>
 struct Node;
 
-struct CountedNodePtr {
-    Node* ptr;
-    unsigned int count;
+template <typename T>
+struct Node<T, true> : NodeLink {
+    T value;
 };
 
-inline bool operator==(const CountedNodePtr &lhs, const CountedNodePtr &rhs) {
-    return lhs.ptr == rhs.ptr && lhs.count == rhs.count;
-}
+template <typename T>
+struct Node<T, false> : NodeLink {
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* payload() { return std::launder(reinterpret_cast<T*>(storage)); }
+};
 
-static_assert(std::is_trivial<CountedNodePtr>::value, "CountedNodePtr must be a trivial type");
+struct MSQueueConfig {
+    bool use_pool = true;
+    // Retired nodes a thread accumulates before it scans the hazard pointers.
+    size_t reclaim_threshold = 128;
+    // Free nodes kept on the pool's shared list before the rest go back to the allocator.
+    size_t max_pooled_nodes = 1 << 16;
+    // Applied after a lost CAS on tail->next (enq) or head (deq).
+    BackoffPolicy backoff = BackoffPolicy::None;
+};
 
-struct Node {
-    int value;
-    std::atomic<CountedNodePtr> next;
+// Per-thread-slot counters, one cache line each: attempts and failures of the
+// linearizing CASes, and the nodes this slot linked in or unlinked. Each slot
+// has a single writer, so updates are a relaxed load and store, never an RMW.
+struct alignas(64) OpCounters {
+    std::atomic<uint64_t> cas_attempts;
+    std::atomic<uint64_t> cas_failures;
+    std::atomic<uint64_t> enqueued;
+    std::atomic<uint64_t> dequeued;
+};
+
+struct ContentionStats {
+    uint64_t cas_attempts;
+    uint64_t cas_failures;
 
-    Node(int val) : value(val) {
-        CountedNodePtr initNext = { nullptr, 0 };
-        next.store(initNext, std::memory_order_relaxed);
+    double failureRate() const {
+        return cas_attempts ? static_cast<double>(cas_failures) / cas_attempts : 0.0;
     }
 };
 
-struct MSQueue {
+// A consumer suspended until a value is handed to it. slot points at the
+// consumer's std::optional<T>; wake reschedules it once the slot is filled.
+struct AsyncWaiter {
+    void* slot;
+    void (*wake)(AsyncWaiter* waiter);
+};
+
+template <typename T>
+struct MSQueue;
+
+// Everything the algorithm needs that does not depend on the payload type.
+struct MSQueueBase {
     std::atomic<CountedNodePtr> head;
     std::atomic<CountedNodePtr> tail;
+    NodePool* pool;
+    HazardDomain* hazards;
+    NodePool::Creator create_node;
+    NodePool::Destroyer destroy_node;
+    // Consumers parked in dequeue_wait sleep on wake_seq; producers only look at
+    // waiters and skip the syscall while it is zero.
+    alignas(64) std::atomic<uint32_t> waiters;
+    std::atomic<uint32_t> wake_seq;
+    std::atomic<uint32_t> spin_budget;
+    // Suspended coroutine consumers wait in FIFO order in a queue of their own,
+    // created on first use. async_waiting also counts a waiter held in
+    // async_front, so producers never miss one. Only the thread that raised
+    // match_requests from zero takes waiters, which keeps async_front private to
+    // it and lets an unserved waiter keep its place at the front.
+    std::atomic<size_t> async_waiting;
+    std::atomic<MSQueue<AsyncWaiter*>*> async_waiters;
+    std::atomic<bool> async_fenced;
+    std::atomic<uint64_t> match_requests;
+    AsyncWaiter* async_front;
+    BackoffPolicy backoff;
+    OpCounters* counters;
 };
 
-bool enq(MSQueue* q, int value);
-int deq(MSQueue* q);
+template <typename T>
+struct MSQueue : MSQueueBase {};
+
+NodeLink* allocNode(MSQueueBase* q);
+void freeNode(MSQueueBase* q, NodeLink* node);
+CountedNodePtr protectNode(HazardDomain::Record* rec, size_t index,
+                           const std::atomic<CountedNodePtr>& src);
+// Links the private chain first..last (count nodes) after the current last node
+// with one CAS.
+void appendChain(MSQueueBase* q, NodeLink* first, NodeLink* last, size_t count);
+void initMSQueue(MSQueueBase* q, const MSQueueConfig& config,
+                 NodePool::Creator create, NodePool::Destroyer destroy);
+void destroyMSQueue(MSQueueBase* q);
+ContentionStats contentionStats(const MSQueueBase* q);
+void resetContentionStats(MSQueueBase* q);
+// Enqueued minus dequeued over all thread slots: O(MAX_THREADS), safe while the
+// queue is in use, and exact once it is quiescent. Hand-offs to coroutine
+// consumers never enter the queue and are not counted.
+size_t size_approx(const MSQueueBase* q);
+
+inline void addToCounter(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void recordOp(MSQueueBase* q, uint64_t attempts, uint64_t failures,
+                     uint64_t enqueued, uint64_t dequeued) {
+    OpCounters& slot = q->counters[currentThreadSlot()];
+    addToCounter(slot.cas_attempts, attempts);
+    addToCounter(slot.cas_failures, failures);
+    if (enqueued != 0) {
+        addToCounter(slot.enqueued, enqueued);
+    }
+    if (dequeued != 0) {
+        addToCounter(slot.dequeued, dequeued);
+    }
+}
+void wakeConsumers(MSQueueBase* q, uint32_t count);
+// Sleeps until wake_seq moves on from seq; false once the deadline (if any) passed.
+bool parkConsumer(MSQueueBase* q, uint32_t seq, const std::chrono::steady_clock::time_point* deadline);
+
+// Registers a suspended consumer. Returns true if the queue has items once the
+// waiter is visible, in which case the caller must match them up.
+bool publishAsyncWaiter(MSQueueBase* q, AsyncWaiter* waiter);
+// Oldest registered waiter, or nullptr. Only the matcher may call these two.
+AsyncWaiter* takeAsyncWaiter(MSQueueBase* q);
+// Puts back a waiter that could not be served, ahead of every other waiter.
+void returnAsyncWaiter(MSQueueBase* q, AsyncWaiter* waiter);
+bool queueHasItems(MSQueueBase* q);
+
+template <typename T>
+bool try_dequeue(MSQueue<T>* q, T& out);
+
+template <typename T>
+void deliverAsync(MSQueueBase* q, AsyncWaiter* waiter, T&& value) {
+    static_cast<std::optional<T>*>(waiter->slot)->emplace(std::move(value));
+    q->async_waiting.fetch_sub(1, std::memory_order_relaxed);
+    waiter->wake(waiter);
+}
+
+// Pairs queued values with suspended consumers, oldest first, until one side
+// runs out. Caller must be the matcher.
+template <typename T>
+void serveAsyncWaiters(MSQueue<T>* q) {
+    while (AsyncWaiter* waiter = takeAsyncWaiter(q)) {
+        T value{};
+        if (!try_dequeue(q, value)) {
+            returnAsyncWaiter(q, waiter);
+            return;
+        }
+        deliverAsync(q, waiter, std::move(value));
+    }
+}
+
+// Gives up the matcher role taken with claimed requests, serving once more for
+// every batch of requests that arrived meanwhile.
+template <typename T>
+void releaseMatcher(MSQueue<T>* q, uint64_t claimed) {
+    while ((claimed = q->match_requests.fetch_sub(claimed, std::memory_order_acq_rel) - claimed) != 0) {
+        serveAsyncWaiters(q);
+    }
+}
+
+// Serves waiters now, or leaves it to the current matcher, which is bound to
+// see this request before it lets go.
+template <typename T>
+void matchAsyncWaiters(MSQueue<T>* q) {
+    if (q->match_requests.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        serveAsyncWaiters(q);
+        releaseMatcher(q, 1);
+    }
+}
+
+// Pairs with the heavy fence a consumer issues after registering as a waiter, so
+// either it sees the new node or this thread sees it waiting. Coroutine
+// consumers use plain fences instead, so only queues that have had one pay a
+// seq_cst fence here.
+template <typename T>
+void notifyConsumers(MSQueue<T>* q, uint32_t count) {
+    asymmetricLightFence();
+    if (q->waiters.load(std::memory_order_relaxed) != 0) {
+        wakeConsumers(q, count);
+    }
+    // Coroutine consumers need a default-constructible T, so no other queue can have any.
+    if constexpr (std::is_default_constructible<T>::value) {
+        if (q->async_waiters.load(std::memory_order_relaxed) != nullptr) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (q->async_waiting.load(std::memory_order_relaxed) != 0) {
+                matchAsyncWaiters(q);
+            }
+        }
+    }
+}
+
+template <typename T, typename... Args>
+Node<T>* makeNode(MSQueue<T>* q, Args&&... args) {
+    Node<T>* node = static_cast<Node<T>*>(allocNode(q));
+    if constexpr (InlinePayload<T>::value) {
+        node->value = T(std::forward<Args>(args)...);
+    } else {
+        new (node->storage) T(std::forward<Args>(args)...);
+    }
+    return node;
+}
+
+// Constructs the payload in place from args. If the queue is empty and a
+// coroutine consumer is suspended, the oldest one gets the value directly and
+// the queue is never touched; with values still queued that would overtake them.
+template <typename T, typename... Args>
+bool enq(MSQueue<T>* q, Args&&... args) {
+    uint64_t idle = 0;
+    if (q->async_waiting.load(std::memory_order_acquire) != 0 &&
+        q->match_requests.compare_exchange_strong(idle, 1, std::memory_order_acq_rel)) {
+        AsyncWaiter* waiter = queueHasItems(q) ? nullptr : takeAsyncWaiter(q);
+        if (waiter != nullptr) {
+            deliverAsync(q, waiter, T(std::forward<Args>(args)...));
+        }
+        releaseMatcher(q, 1);
+        if (waiter != nullptr) {
+            return true;
+        }
+    }
+
+    Node<T>* node = makeNode(q, std::forward<Args>(args)...);
+    appendChain(q, node, node, 1);
+    notifyConsumers(q, 1);
+    return true;
+}
+
+// Unbounded, so this always succeeds; it exists for code shared with the rings.
+template <typename T, typename... Args>
+bool try_enqueue(MSQueue<T>* q, Args&&... args) {
+    return enq(q, std::forward<Args>(args)...);
+}
+
+template <typename T>
+bool try_dequeue(MSQueue<T>* q, T& out) {
+    HazardDomain::Record* rec = q->hazards->record();
+    Backoff backoff(q->backoff);
+    uint64_t failures = 0;
+    CountedNodePtr head, tail, next;
+    while (true) {
+        head = protectNode(rec, 0, q->head);
+        tail = q->tail.load(std::memory_order_acquire);
+        next = ptr_of(head)->next.load(std::memory_order_acquire);
+        // next cannot be retired before head moves past it, so re-checking head
+        // after publishing the hazard is enough to keep next alive.
+        HazardDomain::protect(rec, 1, ptr_of(next));
+        if (head == q->head.load(std::memory_order_acquire)) {
+            if (ptr_of(head) == ptr_of(tail)) {
+                if (ptr_of(next) == nullptr) {
+                    HazardDomain::clear(rec);
+                    if (failures != 0) {
+                        recordOp(q, failures, failures, 0, 0);
+                    }
+                    return false;
+                }
+                CountedNodePtr newTail = make_counted<CountedNodePtr>(ptr_of(next), count_of(tail) + 1);
+                q->tail.compare_exchange_weak(tail, newTail,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed);
+            } else {
+                Node<T>* node = static_cast<Node<T>*>(ptr_of(next));
+                typename std::conditional<InlinePayload<T>::value, T, char>::type value{};
+                if constexpr (InlinePayload<T>::value) {
+                    value = node->value;
+                }
+                CountedNodePtr newHead = make_counted<CountedNodePtr>(node, count_of(head) + 1);
+                if (q->head.compare_exchange_weak(head, newHead,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+                    // The new dummy's payload now belongs to this thread alone, and
+                    // hazard slot 1 keeps the node itself alive until it is moved out.
+                    if constexpr (InlinePayload<T>::value) {
+                        out = value;
+                    } else {
+                        out = std::move(*node->payload());
+                        node->payload()->~T();
+                    }
+                    HazardDomain::clear(rec);
+                    q->hazards->retire(rec, ptr_of(head));
+                    recordOp(q, failures + 1, failures, 0, 1);
+                    return true;
+                }
+                failures++;
+                backoff.pause();
+            }
+        }
+    }
+}
+
+constexpr uint32_t MIN_DEQUEUE_SPIN = 16;
+constexpr uint32_t MAX_DEQUEUE_SPIN = 4096;
+
+// Spins for a budget that grows when spinning pays off and shrinks when it ends
+// in a park, then sleeps on the queue's futex word. deadline == nullptr waits forever.
+template <typename T>
+bool dequeue_wait_until(MSQueue<T>* q, T& out, const std::chrono::steady_clock::time_point* deadline) {
+    uint32_t budget = q->spin_budget.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < budget; ++i) {
+        if (try_dequeue(q, out)) {
+            if (i > 0 && budget < MAX_DEQUEUE_SPIN) {
+                q->spin_budget.store(std::min(MAX_DEQUEUE_SPIN, budget * 2), std::memory_order_relaxed);
+            }
+            return true;
+        }
+        cpuRelax();
+    }
+    if (budget > MIN_DEQUEUE_SPIN) {
+        q->spin_budget.store(std::max(MIN_DEQUEUE_SPIN, budget / 2), std::memory_order_relaxed);
+    }
+
+    while (true) {
+        q->waiters.fetch_add(1, std::memory_order_relaxed);
+        uint32_t seq = q->wake_seq.load(std::memory_order_acquire);
+        asymmetricHeavyFence();
+        if (try_dequeue(q, out)) {
+            q->waiters.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        bool in_time = parkConsumer(q, seq, deadline);
+        q->waiters.fetch_sub(1, std::memory_order_relaxed);
+        if (try_dequeue(q, out)) {
+            return true;
+        }
+        if (!in_time) {
+            return false;
+        }
+    }
+}
+
+template <typename T>
+void dequeue_wait(MSQueue<T>* q, T& out) {
+    dequeue_wait_until(q, out, nullptr);
+}
+
+// Returns false if nothing arrived within timeout.
+template <typename T, typename Rep, typename Period>
+bool dequeue_wait_for(MSQueue<T>* q, T& out, std::chrono::duration<Rep, Period> timeout) {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+    return dequeue_wait_until(q, out, &deadline);
+}
+
+// Kept for the int benchmarks: -1 doubles as "empty".
+inline int deq(MSQueue<int>* q) {
+    int value;
+    return try_dequeue(q, value) ? value : -1;
+}
+
+template <typename T>
+bool enq_bulk(MSQueue<T>* q, const T* values, size_t n) {
+    if (n == 0) {
+        return true;
+    }
+
+    Node<T>* first = makeNode(q, values[0]);
+    NodeLink* last = first;
+    for (size_t i = 1; i < n; ++i) {
+        Node<T>* node = makeNode(q, values[i]);
+        relinkNode(last, node);
+        last = node;
+    }
+
+    appendChain(q, first, last, n);
+    notifyConsumers(q, static_cast<uint32_t>(std::min<size_t>(n, UINT32_MAX)));
+    return true;
+}
+
+template <typename T>
+size_t deq_bulk(MSQueue<T>* q, T* out, size_t max) {
+    if (max == 0) {
+        return 0;
+    }
+
+    HazardDomain::Record* rec = q->hazards->record();
+    Backoff backoff(q->backoff);
+    uint64_t failures = 0;
+    while (true) {
+        CountedNodePtr head = protectNode(rec, 0, q->head);
+        CountedNodePtr tail = q->tail.load(std::memory_order_acquire);
+        NodeLink* node = ptr_of(head);
+
+        // The tail snapshot was taken while this head was current, so it is at or
+        // past head; stopping there keeps the new head from overtaking the tail.
+        size_t claimed = 0;
+        bool stale = false;
+        while (claimed < max && node != ptr_of(tail)) {
+            NodeLink* next = ptr_of(node->next.load(std::memory_order_acquire));
+            HazardDomain::protect(rec, 1, next);
+            if (!(head == q->head.load(std::memory_order_acquire))) {
+                stale = true;
+                break;
+            }
+            if constexpr (InlinePayload<T>::value) {
+                out[claimed] = static_cast<Node<T>*>(next)->value;
+            }
+            claimed++;
+            node = next;
+        }
+
+        if (stale) {
+            continue;
+        }
+
+        if (claimed == 0) {
+            CountedNodePtr next = ptr_of(head)->next.load(std::memory_order_acquire);
+            if (!(head == q->head.load(std::memory_order_acquire))) {
+                continue;
+            }
+            if (ptr_of(next) == nullptr) {
+                HazardDomain::clear(rec);
+                if (failures != 0) {
+                    recordOp(q, failures, failures, 0, 0);
+                }
+                return 0;
+            }
+            CountedNodePtr newTail = make_counted<CountedNodePtr>(ptr_of(next), count_of(tail) + 1);
+            q->tail.compare_exchange_weak(tail, newTail,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed);
+            continue;
+        }
+
+        CountedNodePtr newHead = make_counted<CountedNodePtr>(node, count_of(head) + 1);
+        if (q->head.compare_exchange_weak(head, newHead,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+            // Claimed nodes are unreachable from head but not yet retired, so only
+            // this thread can touch them; slot 1 still covers the new dummy.
+            NodeLink* retired = ptr_of(head);
+            for (size_t i = 0; i < claimed; ++i) {
+                NodeLink* next = ptr_of(retired->next.load(std::memory_order_relaxed));
+                if constexpr (!InlinePayload<T>::value) {
+                    Node<T>* claimedNode = static_cast<Node<T>*>(next);
+                    out[i] = std::move(*claimedNode->payload());
+                    claimedNode->payload()->~T();
+                }
+                q->hazards->retire(rec, retired);
+                retired = next;
+            }
+            HazardDomain::clear(rec);
+            recordOp(q, failures + 1, failures, 0, claimed);
+            return claimed;
+        }
+        failures++;
+        backoff.pause();
+    }
+}
+
+int countQueue(MSQueueBase* q);
+
+template <typename T>
+void printQueue(MSQueue<T>* q) {
+    NodeLink* node = ptr_of(q->head.load(std::memory_order_acquire));
+
+    if (node == nullptr) {
+        std::cout << "Queue is empty (dummy head not set).\n";
+        return;
+    }
+
+    NodeLink* next = ptr_of(node->next.load(std::memory_order_acquire));
+
+    if (next == nullptr) {
+        std::cout << "Queue is empty\n";
+        return;
+    }
+
+    std::cout << "Queue elements: ";
+    while (next != nullptr) {
+        Node<T>* typed = static_cast<Node<T>*>(next);
+        if constexpr (InlinePayload<T>::value) {
+            std::cout << typed->value << " ";
+        } else {
+            std::cout << *typed->payload() << " ";
+        }
+        next = ptr_of(next->next.load(std::memory_order_acquire));
+    }
+
+    std::cout << std::endl;
+}
+
+template <typename T = int>
+MSQueue<T>* createMSQueue(const MSQueueConfig& config = MSQueueConfig()) {
+    MSQueue<T>* q = new MSQueue<T>();
+    initMSQueue(q, config,
+                []() -> NodeLink* { return new Node<T>(); },
+                [](NodeLink* node) { delete static_cast<Node<T>*>(node); });
+    return q;
+}
+
+// Not safe against concurrent use; payloads still queued are destroyed in place.
+template <typename T>
+void deleteMSQueue(MSQueue<T>* q) {
+    if constexpr (!InlinePayload<T>::value) {
+        NodeLink* node = ptr_of(ptr_of(q->head.load(std::memory_order_relaxed))->next.load(std::memory_order_relaxed));
+        while (node != nullptr) {
+            static_cast<Node<T>*>(node)->payload()->~T();
+            node = ptr_of(node->next.load(std::memory_order_relaxed));
+        }
+    }
+    destroyMSQueue(q);
+    delete q;
+}
 
-void printQueue(MSQueue* q);
-int countQueue(MSQueue* q);
-MSQueue* createMSQueue();
-void deleteMSQueue(MSQueue* q);
+void printLockFreeStatus();
 
 #endif
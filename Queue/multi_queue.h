@@ -0,0 +1,147 @@
+#ifndef MULTI_QUEUE_H
+#define MULTI_QUEUE_H
+
+#include "ms_queue.h"
+#include "thread_registry.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+// Relaxed-FIFO multi-queue: N independent MSQueue lanes. Producers append to the
+// lane picked by their thread slot, consumers drain that lane first and then
+// steal from the fuller of two random lanes. Each lane stays FIFO, but there is
+// no global order, so a value can be overtaken by values enqueued after it on
+// another lane. In exchange there is no single head or tail every thread hits.
+template <typename T>
+struct MultiQueue {
+    struct alignas(64) Lane {
+        MSQueue<T>* queue;
+        // Only steers stealing; a relaxed hint, not an exact length.
+        std::atomic<int64_t> size_hint;
+    };
+
+    Lane* lanes;
+    size_t lane_count;
+};
+
+constexpr int MULTI_QUEUE_STEAL_ATTEMPTS = 2;
+
+// lane_count == 0 picks two lanes per hardware thread.
+template <typename T>
+MultiQueue<T>* createMultiQueue(size_t lane_count = 0, const MSQueueConfig& config = MSQueueConfig()) {
+    if (lane_count == 0) {
+        lane_count = 2 * std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    MultiQueue<T>* mq = new MultiQueue<T>();
+    mq->lanes = new typename MultiQueue<T>::Lane[lane_count];
+    mq->lane_count = lane_count;
+    for (size_t i = 0; i < lane_count; ++i) {
+        mq->lanes[i].queue = createMSQueue<T>(config);
+        mq->lanes[i].size_hint.store(0, std::memory_order_relaxed);
+    }
+    return mq;
+}
+
+// Not safe against concurrent use.
+template <typename T>
+void deleteMultiQueue(MultiQueue<T>* mq) {
+    for (size_t i = 0; i < mq->lane_count; ++i) {
+        deleteMSQueue(mq->lanes[i].queue);
+    }
+    delete[] mq->lanes;
+    delete mq;
+}
+
+template <typename T>
+size_t homeLane(const MultiQueue<T>* mq) {
+    return currentThreadSlot() % mq->lane_count;
+}
+
+inline uint32_t nextLaneChoice() {
+    static thread_local uint32_t state = 0x2545F491u ^ static_cast<uint32_t>(currentThreadSlot() * 0x9E3779B9u);
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+template <typename T, typename... Args>
+bool enq(MultiQueue<T>* mq, Args&&... args) {
+    typename MultiQueue<T>::Lane& lane = mq->lanes[homeLane(mq)];
+    enq(lane.queue, std::forward<Args>(args)...);
+    lane.size_hint.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <typename T, typename... Args>
+bool try_enqueue(MultiQueue<T>* mq, Args&&... args) {
+    return enq(mq, std::forward<Args>(args)...);
+}
+
+template <typename T>
+bool try_dequeue_lane(MultiQueue<T>* mq, size_t index, T& out) {
+    typename MultiQueue<T>::Lane& lane = mq->lanes[index];
+    if (!try_dequeue(lane.queue, out)) {
+        return false;
+    }
+    lane.size_hint.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Home lane, then power-of-two-choices steals, then a sweep of every lane so a
+// false return means all lanes were seen empty.
+template <typename T>
+bool try_dequeue(MultiQueue<T>* mq, T& out) {
+    size_t home = homeLane(mq);
+    if (try_dequeue_lane(mq, home, out)) {
+        return true;
+    }
+
+    size_t n = mq->lane_count;
+    for (int attempt = 0; attempt < MULTI_QUEUE_STEAL_ATTEMPTS; ++attempt) {
+        uint32_t r = nextLaneChoice();
+        size_t a = (r & 0xFFFF) % n;
+        size_t b = (r >> 16) % n;
+        size_t pick = mq->lanes[a].size_hint.load(std::memory_order_relaxed) >=
+                      mq->lanes[b].size_hint.load(std::memory_order_relaxed) ? a : b;
+        if (pick != home && try_dequeue_lane(mq, pick, out)) {
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < n; ++i) {
+        if (try_dequeue_lane(mq, (home + i) % n, out)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline int deq(MultiQueue<int>* mq) {
+    int value;
+    return try_dequeue(mq, value) ? value : -1;
+}
+
+template <typename T>
+size_t size_approx(const MultiQueue<T>* mq) {
+    size_t total = 0;
+    for (size_t i = 0; i < mq->lane_count; ++i) {
+        total += size_approx(mq->lanes[i].queue);
+    }
+    return total;
+}
+
+template <typename T>
+int countQueue(MultiQueue<T>* mq) {
+    int total = 0;
+    for (size_t i = 0; i < mq->lane_count; ++i) {
+        total += countQueue(mq->lanes[i].queue);
+    }
+    return total;
+}
+
+#endif
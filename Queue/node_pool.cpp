@@ -0,0 +1,123 @@
+#include "node_pool.h"
+
+NodePool::NodePool(size_t max_cached, Creator create, Destroyer destroy)
+    : max_cached(max_cached), create_node(create), destroy_node(destroy),
+      shared_cached(0), total_allocated(0), total_freed(0)
+{
+    for (size_t i = 0; i < MAX_THREADS; ++i) {
+        caches[i].store(nullptr, std::memory_order_relaxed);
+    }
+    free_head.store(make_counted<CountedNodePtr>(nullptr, 0), std::memory_order_relaxed);
+}
+
+NodePool::~NodePool() {
+    for (size_t i = 0; i < MAX_THREADS; ++i) {
+        LocalCache* cache = caches[i].load(std::memory_order_relaxed);
+        if (!cache) continue;
+        for (size_t j = 0; j < cache->count; ++j) {
+            destroy_node(cache->nodes[j]);
+        }
+        while (cache->chain) {
+            NodeLink* next = ptr_of(cache->chain->next.load(std::memory_order_relaxed));
+            destroy_node(cache->chain);
+            cache->chain = next;
+        }
+        delete cache;
+    }
+    
+    NodeLink* node = ptr_of(free_head.load(std::memory_order_relaxed));
+    while (node) {
+        NodeLink* next = ptr_of(node->next.load(std::memory_order_relaxed));
+        destroy_node(node);
+        node = next;
+    }
+}
+
+NodePool::LocalCache* NodePool::localCache() {
+    size_t slot = currentThreadSlot();
+    LocalCache* cache = caches[slot].load(std::memory_order_acquire);
+    if (!cache) {
+        cache = new LocalCache();
+        caches[slot].store(cache, std::memory_order_release);
+    }
+    return cache;
+}
+
+// Both ends of the shared free list move whole chains with a single CAS and never
+// dereference a node they do not already own, so a stale head only costs a retry.
+// The taker keeps the whole chain privately and hands it out one node at a time.
+void NodePool::pushChain(NodeLink* first, NodeLink* last) {
+    CountedNodePtr head = free_head.load(std::memory_order_relaxed);
+    CountedNodePtr newHead;
+    do {
+        relinkNode(last, ptr_of(head));
+        newHead = make_counted<CountedNodePtr>(first, count_of(head) + 1);
+    } while (!free_head.compare_exchange_weak(head, newHead,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+}
+
+NodeLink* NodePool::takeAll() {
+    CountedNodePtr head = free_head.load(std::memory_order_relaxed);
+    while (ptr_of(head) != nullptr) {
+        CountedNodePtr empty = make_counted<CountedNodePtr>(nullptr, count_of(head) + 1);
+        if (free_head.compare_exchange_weak(head, empty,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+            shared_cached.exchange(0, std::memory_order_relaxed);
+            return ptr_of(head);
+        }
+    }
+    return nullptr;
+}
+
+NodeLink* NodePool::allocate() {
+    LocalCache* cache = localCache();
+    
+    NodeLink* node;
+    if (cache->count > 0) {
+        node = cache->nodes[--cache->count];
+    } else {
+        if (!cache->chain) {
+            cache->chain = takeAll();
+        }
+        
+        if (!cache->chain) {
+            for (size_t i = 0; i < REFILL_BATCH; ++i) {
+                cache->nodes[cache->count++] = create_node();
+            }
+            total_allocated.fetch_add(REFILL_BATCH, std::memory_order_relaxed);
+            node = cache->nodes[--cache->count];
+        } else {
+            node = cache->chain;
+            cache->chain = ptr_of(node->next.load(std::memory_order_relaxed));
+        }
+    }
+    
+    relinkNode(node, nullptr);
+    return node;
+}
+
+void NodePool::release(NodeLink* node) {
+    LocalCache* cache = localCache();
+    
+    if (cache->count == LOCAL_CAPACITY && shared_cached.load(std::memory_order_relaxed) >= max_cached) {
+        for (size_t i = 0; i < REFILL_BATCH; ++i) {
+            destroy_node(cache->nodes[--cache->count]);
+        }
+        total_freed.fetch_add(REFILL_BATCH, std::memory_order_relaxed);
+    } else if (cache->count == LOCAL_CAPACITY) {
+        NodeLink* first = cache->nodes[cache->count - 1];
+        NodeLink* last = first;
+        for (size_t i = 1; i < REFILL_BATCH; ++i) {
+            NodeLink* n = cache->nodes[cache->count - 1 - i];
+            relinkNode(last, n);
+            last = n;
+        }
+        cache->count -= REFILL_BATCH;
+        shared_cached.fetch_add(REFILL_BATCH, std::memory_order_relaxed);
+        pushChain(first, last);
+    }
+    
+    cache->nodes[cache->count++] = node;
+}
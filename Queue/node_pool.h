@@ -0,0 +1,50 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include "counted_ptr.h"
+#include "thread_registry.h"
+#include <atomic>
+#include <mutex>
+
+class NodePool {
+public:
+    typedef NodeLink* (*Creator)();
+    typedef void (*Destroyer)(NodeLink* node);
+
+    // Nodes beyond max_cached on the shared free list are returned to the allocator.
+    // Only safe while the owner guarantees no thread can still read a released node.
+    // The pool never touches payloads: create and destroy only build the typed node.
+    NodePool(size_t max_cached, Creator create, Destroyer destroy);
+    ~NodePool();
+
+    NodeLink* allocate();
+    void release(NodeLink* node);
+
+    size_t allocated() const { return total_allocated.load(std::memory_order_relaxed); }
+    size_t live() const { return allocated() - total_freed.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t LOCAL_CAPACITY = 64;
+    static constexpr size_t REFILL_BATCH = LOCAL_CAPACITY / 2;
+
+    struct alignas(64) LocalCache {
+        NodeLink* nodes[LOCAL_CAPACITY];
+        size_t count = 0;
+        NodeLink* chain = nullptr;
+    };
+
+    LocalCache* localCache();
+    void pushChain(NodeLink* first, NodeLink* last);
+    NodeLink* takeAll();
+
+    std::atomic<LocalCache*> caches[MAX_THREADS];
+    size_t max_cached;
+    Creator create_node;
+    Destroyer destroy_node;
+    alignas(64) std::atomic<CountedNodePtr> free_head;
+    std::atomic<size_t> shared_cached;
+    std::atomic<size_t> total_allocated;
+    std::atomic<size_t> total_freed;
+};
+
+#endif
@@ -1,4 +1,16 @@
 #include "ms_queue.h"
+#include "node_pool.h"
+#include "hazard_pointers.h"
+#include "faa_queue.h"
+#include "bounded_queue.h"
+#include "role_queue.h"
+#include "async_queue.h"
+#include "fc_queue.h"
+#include "multi_queue.h"
+#include "ws_deque.h"
+#include "thread_pool.h"
+#include "bench_harness.h"
+#include "lock_queue.h"
 #include <iostream>
 #include <vector>
 #include <thread>
@@ -8,6 +20,12 @@
 #include <fstream>
 #include <filesystem>
 #include <iomanip>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <ctime>
+#include <cstdlib>
+#include <sstream>
 #include <boost/lockfree/queue.hpp>
 
 using namespace std;
@@ -33,11 +51,37 @@ std::vector<uint32_t> read_binary_data(const std::string& file_path, size_t n) {
     return data;
 }
 
-void run_correctness_test() {
-    std::cout << "\n=== Running Correctness Tests ===\n";
-    
+// Fire-and-forget coroutine: starts eagerly and frees its frame when it finishes.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+DetachedTask consume_one(MSQueue<int>* q, CoroExecutor* executor, std::vector<std::atomic<int>>* seen,
+                         std::atomic<size_t>* done) {
+    int value = co_await dequeue_async(q, executor);
+    (*seen)[value].fetch_add(1, std::memory_order_relaxed);
+    done->fetch_add(1, std::memory_order_relaxed);
+}
+
+// Also records whether the coroutine suspended, which is exactly when it is
+// resumed from run_pending.
+DetachedTask consume_in_order(MSQueue<int>* q, CoroExecutor* executor, const bool* draining,
+                              int* received, int* suspended, std::atomic<size_t>* done) {
+    int value = co_await dequeue_async(q, executor);
+    *received = value;
+    *suspended = *draining;
+    done->fetch_add(1, std::memory_order_relaxed);
+}
+
+void test_single_threaded() {
     std::cout << "Starting single-threaded tests...\n";
-    MSQueue* q = createMSQueue();
+    MSQueue<int>* q = createMSQueue();
     
     int res = deq(q);
     if (res != -1) {
@@ -82,9 +126,11 @@ void run_correctness_test() {
     }
     
     deleteMSQueue(q);
-    
+}
+
+void test_multi_threaded() {
     std::cout << "\nStarting multi-threaded tests...\n";
-    q = createMSQueue();
+    MSQueue<int>* q = createMSQueue();
     
     std::atomic<int> enq_count(0);
     std::atomic<int> deq_count(0);
@@ -147,333 +193,2399 @@ void run_correctness_test() {
     std::cout << "Total successful dequeues: " << deq_count.load() << "\n";
     std::cout << "Total empty queue returns: " << empty_returns.load() << "\n";
     std::cout << "Final queue size: " << countQueue(q) << "\n";
-    
     deleteMSQueue(q);
-    std::cout << "Correctness tests completed\n";
 }
 
-void run_performance_test(size_t thread_count, size_t op_count, int enq_probability = 50) {
-    std::cout << "\n=== Running Performance Test ===\n";
-    std::cout << "Threads: " << thread_count << ", Operations per thread: " << op_count 
-              << ", Enqueue probability: " << enq_probability << "%\n";
-    
-    MSQueue* q = createMSQueue();
+void test_producer_consumer() {
+    std::cout << "\nStarting producer/consumer conservation test...\n";
+    MSQueue<int>* q = createMSQueue();
+    
+    const int num_producers = 4;
+    const int num_consumers = 4;
+    const int items_per_producer = 50000;
+    const int total_items = num_producers * items_per_producer;
+    std::vector<std::atomic<int>> seen(total_items);
+    std::atomic<int> consumed(0);
+    std::atomic<bool> order_ok(true);
     
-    std::vector<uint32_t> enq_values;
-    size_t total_ops = thread_count * op_count;
-    size_t expected_enqueues = total_ops * enq_probability / 100;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < num_producers; p++) {
+        threads.emplace_back([&q, p, items_per_producer]() {
+            for (int j = 0; j < items_per_producer; j++) {
+                enq(q, p * items_per_producer + j);
+            }
+        });
+    }
+    for (int c = 0; c < num_consumers; c++) {
+        threads.emplace_back([&]() {
+            std::vector<int> last_from(num_producers, -1);
+            while (consumed.load(std::memory_order_relaxed) < total_items) {
+                int value = deq(q);
+                if (value == -1) continue;
+                seen[value].fetch_add(1, std::memory_order_relaxed);
+                int producer = value / items_per_producer;
+                if (value <= last_from[producer]) {
+                    order_ok.store(false, std::memory_order_relaxed);
+                }
+                last_from[producer] = value;
+                consumed.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
     
-    std::string file_path = "bin/random_values_insert.bin";
-    if (std::filesystem::exists(file_path)) {
-        enq_values = read_binary_data(file_path, expected_enqueues);
-    } else {
-        std::cout << "Warning: Binary file not found. Using generated values instead.\n";
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<uint32_t> dis(1, 1000000);
-        
-        enq_values.resize(expected_enqueues);
-        for (auto& val : enq_values) {
-            val = dis(gen);
-        }
+    for (auto& t : threads) {
+        t.join();
     }
     
-    std::atomic<size_t> enq_index(0);
+    int duplicates_or_lost = 0;
+    for (int i = 0; i < total_items; i++) {
+        if (seen[i].load() != 1) duplicates_or_lost++;
+    }
     
-    std::atomic<size_t> actual_enqueues(0);
-    std::atomic<size_t> actual_dequeues(0);
-    std::atomic<size_t> empty_dequeues(0);
+    if (duplicates_or_lost != 0) {
+        std::cerr << "FAIL: " << duplicates_or_lost << " values were lost or dequeued twice\n";
+    } else {
+        std::cout << "PASS: All " << total_items << " values dequeued exactly once\n";
+    }
+    if (!order_ok.load()) {
+        std::cerr << "FAIL: Values from one producer were dequeued out of order\n";
+    } else {
+        std::cout << "PASS: Per-producer FIFO order preserved\n";
+    }
     
-    auto worker = [&](int thread_id) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> op_dis(0, 99);
-        
-        for (size_t i = 0; i < op_count; i++) {
-            if (op_dis(gen) < enq_probability) {
-                size_t idx = enq_index.fetch_add(1, std::memory_order_relaxed);
-                int value = (idx < enq_values.size()) ? enq_values[idx] : thread_id * 1000 + i;
-                enq(q, value);
-                actual_enqueues.fetch_add(1, std::memory_order_relaxed);
-            } else {
-                int result = deq(q);
-                if (result != -1) {
-                    actual_dequeues.fetch_add(1, std::memory_order_relaxed);
-                } else {
-                    empty_dequeues.fetch_add(1, std::memory_order_relaxed);
+    deleteMSQueue(q);
+}
+
+void test_reclamation() {
+    std::cout << "\nStarting sustained-load reclamation test...\n";
+    MSQueueConfig config;
+    config.reclaim_threshold = 64;
+    config.max_pooled_nodes = 1024;
+    MSQueue<int>* q = createMSQueue(config);
+    
+    const int reclaim_threads = 4;
+    const int rounds = 200000;
+    const int burst = 16;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < reclaim_threads; t++) {
+        threads.emplace_back([&q, t, rounds, burst]() {
+            for (int r = 0; r < rounds / burst; r++) {
+                for (int j = 0; j < burst; j++) {
+                    enq(q, t * rounds + r);
+                }
+                for (int j = 0; j < burst; j++) {
+                    deq(q);
                 }
             }
-        }
-    };
+        });
+    }
     
-    auto start_time = HR::now();
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    size_t live_nodes = q->pool->live();
+    size_t node_bound = reclaim_threads * (burst + config.reclaim_threshold + 2 * 64) + config.max_pooled_nodes + 64;
+    std::cout << "Nodes retired and reclaimed: " << q->hazards->reclaimed() 
+              << ", still pending: " << q->hazards->pending() << "\n";
+    std::cout << "Nodes live: " << live_nodes << " (allocated " << q->pool->allocated() 
+              << " over " << reclaim_threads * rounds * 2 << " operations)\n";
+    if (live_nodes > node_bound) {
+        std::cerr << "FAIL: Live nodes exceed the expected bound of " << node_bound << "\n";
+    } else {
+        std::cout << "PASS: Live nodes stay within " << node_bound << "\n";
+    }
+    
+    deleteMSQueue(q);
+}
+
+void test_bulk_operations() {
+    std::cout << "\nStarting bulk enqueue/dequeue test...\n";
+    const int num_producers = 4;
+    const int num_consumers = 4;
+    const int items_per_producer = 50000;
+    const int total_items = num_producers * items_per_producer;
+    std::vector<std::atomic<int>> seen(total_items);
+    MSQueue<int>* q = createMSQueue();
+    
+    int bulk_values[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    int bulk_out[8] = {0};
+    enq_bulk(q, bulk_values, 5);
+    enq(q, 6);
+    size_t got = deq_bulk(q, bulk_out, 4);
+    size_t rest = deq_bulk(q, bulk_out + 4, 4);
+    bool bulk_ok = got == 4 && rest == 2 && deq_bulk(q, bulk_out, 4) == 0;
+    for (int i = 0; i < 6; i++) {
+        if (bulk_out[i] != i + 1) bulk_ok = false;
+    }
+    if (!bulk_ok) {
+        std::cerr << "FAIL: Single-threaded bulk operations returned the wrong values\n";
+    } else {
+        std::cout << "PASS: Bulk operations preserve FIFO order and stop at empty\n";
+    }
     
+    const int bulk_chunk = 37;
+    std::atomic<int> consumed(0);
+    std::atomic<bool> order_ok(true);
     std::vector<std::thread> threads;
-    for (size_t i = 0; i < thread_count; i++) {
-        threads.emplace_back(worker, i);
+    for (int p = 0; p < num_producers; p++) {
+        threads.emplace_back([&q, p, items_per_producer, bulk_chunk]() {
+            std::vector<int> chunk(bulk_chunk);
+            for (int j = 0; j < items_per_producer; j += bulk_chunk) {
+                int n = std::min(bulk_chunk, items_per_producer - j);
+                for (int k = 0; k < n; k++) {
+                    chunk[k] = p * items_per_producer + j + k;
+                }
+                enq_bulk(q, chunk.data(), n);
+            }
+        });
+    }
+    for (int c = 0; c < num_consumers; c++) {
+        threads.emplace_back([&]() {
+            std::vector<int> last_from(num_producers, -1);
+            std::vector<int> out(bulk_chunk);
+            while (consumed.load(std::memory_order_relaxed) < total_items) {
+                size_t n = deq_bulk(q, out.data(), out.size());
+                for (size_t k = 0; k < n; k++) {
+                    int value = out[k];
+                    seen[value].fetch_add(1, std::memory_order_relaxed);
+                    int producer = value / items_per_producer;
+                    if (value <= last_from[producer]) {
+                        order_ok.store(false, std::memory_order_relaxed);
+                    }
+                    last_from[producer] = value;
+                }
+                consumed.fetch_add(n, std::memory_order_relaxed);
+            }
+        });
     }
     
     for (auto& t : threads) {
         t.join();
     }
     
-    auto end_time = HR::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    double elapsed_ms = elapsed.count() / 1000.0;
-    double throughput = (actual_enqueues.load() + actual_dequeues.load()) / (elapsed_ms / 1000.0);
+    int duplicates_or_lost = 0;
+    for (int i = 0; i < total_items; i++) {
+        if (seen[i].load() != 1) duplicates_or_lost++;
+    }
     
-    std::cout << "Performance Results:\n";
-    std::cout << "Total time: " << elapsed_ms << " ms\n";
-    std::cout << "Throughput: " << std::fixed << std::setprecision(2) << throughput 
-              << " operations/second\n";
-    std::cout << "Enqueues performed: " << actual_enqueues.load() << "\n";
-    std::cout << "Successful dequeues: " << actual_dequeues.load() << "\n";
-    std::cout << "Empty dequeues: " << empty_dequeues.load() << "\n";
-    std::cout << "Final queue size: " << countQueue(q) << "\n";
+    if (duplicates_or_lost != 0 || !order_ok.load()) {
+        std::cerr << "FAIL: Bulk operations lost, duplicated or reordered " << duplicates_or_lost << " values\n";
+    } else {
+        std::cout << "PASS: All " << total_items << " bulk values dequeued exactly once in producer order\n";
+    }
     
     deleteMSQueue(q);
 }
 
-void run_scalability_test(size_t op_count = 1000000, int enq_probability = 50) {
-    std::cout << "\n=== Running Scalability Test ===\n";
-    std::cout << "Operations per thread: " << op_count 
-              << ", Enqueue probability: " << enq_probability << "%\n";
-    
-    std::vector<size_t> thread_counts = {1, 2, 4, 8, 16};
+void test_typed_payloads() {
+    std::cout << "\nStarting typed payload tests...\n";
+    MSQueue<int>* q = createMSQueue();
+    int value = 0;
+    enq(q, -1);
+    bool minus_one_ok = try_dequeue(q, value) && value == -1 && !try_dequeue(q, value);
+    if (!minus_one_ok) {
+        std::cerr << "FAIL: A queued -1 could not be told apart from an empty queue\n";
+    } else {
+        std::cout << "PASS: try_dequeue returns a queued -1 and then reports empty\n";
+    }
+    deleteMSQueue(q);
     
-    std::cout << "---------------------------------------------------------\n";
-    std::cout << "| Threads |   Time (ms)  | Throughput (ops/s) | Speedup |\n";
-    std::cout << "---------------------------------------------------------\n";
+    MSQueue<std::unique_ptr<std::string>>* owned = createMSQueue<std::unique_ptr<std::string>>();
+    enq(owned, new std::string("first"));
+    enq(owned, std::make_unique<std::string>("second"));
+    enq(owned, std::make_unique<std::string>("left behind"));
+    std::unique_ptr<std::string> taken;
+    bool owned_ok = try_dequeue(owned, taken) && taken && *taken == "first";
+    owned_ok = owned_ok && try_dequeue(owned, taken) && taken && *taken == "second";
+    if (!owned_ok) {
+        std::cerr << "FAIL: Move-only payloads were not moved out in order\n";
+    } else {
+        std::cout << "PASS: Move-only payloads are moved out in FIFO order\n";
+    }
+    deleteMSQueue(owned);
     
-    double base_throughput = 0;
+    struct Order {
+        uint64_t id;
+        double price;
+        uint32_t quantity;
+    };
+    static_assert(!InlinePayload<Order>::value, "24-byte payloads use the generic node");
+    static_assert(InlinePayload<int>::value, "int payloads are stored inline");
     
-    for (size_t thread_count : thread_counts) {
-        MSQueue* q = createMSQueue();
-        
-        std::vector<uint32_t> enq_values;
-        size_t total_ops = thread_count * op_count;
-        size_t expected_enqueues = total_ops * enq_probability / 100;
-        
-        std::string file_path = "bin/random_values_insert.bin";
-        if (std::filesystem::exists(file_path)) {
-            enq_values = read_binary_data(file_path, expected_enqueues);
-        } else {
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_int_distribution<uint32_t> dis(1, 1000000);
-            
-            enq_values.resize(expected_enqueues);
-            for (auto& val : enq_values) {
-                val = dis(gen);
-            }
-        }
-        
-        std::atomic<size_t> enq_index(0);
-        
-        std::atomic<size_t> actual_ops(0);
-        
-        auto worker = [&](int thread_id) {
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_int_distribution<> op_dis(0, 99);
-            
-            for (size_t i = 0; i < op_count; i++) {
-                if (op_dis(gen) < enq_probability) {
-                    size_t idx = enq_index.fetch_add(1, std::memory_order_relaxed);
-                    int value = (idx < enq_values.size()) ? enq_values[idx] : thread_id * 1000 + i;
-                    enq(q, value);
-                } else {
-                    deq(q);
+    MSQueue<Order>* orders = createMSQueue<Order>();
+    const int order_threads = 4;
+    const int orders_per_thread = 20000;
+    std::atomic<int> order_errors(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < order_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int j = 0; j < orders_per_thread; j++) {
+                uint64_t id = static_cast<uint64_t>(t) * orders_per_thread + j;
+                enq(orders, Order{id, id * 0.5, static_cast<uint32_t>(id)});
+                Order out;
+                if (!try_dequeue(orders, out) || out.price != out.id * 0.5 || out.quantity != static_cast<uint32_t>(out.id)) {
+                    order_errors.fetch_add(1, std::memory_order_relaxed);
                 }
-                actual_ops.fetch_add(1, std::memory_order_relaxed);
             }
-        };
-        
-        auto start_time = HR::now();
-        
-        std::vector<std::thread> threads;
-        for (size_t i = 0; i < thread_count; i++) {
-            threads.emplace_back(worker, i);
-        }
-        
-        for (auto& t : threads) {
-            t.join();
-        }
-        
-        auto end_time = HR::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-        double elapsed_ms = elapsed.count() / 1000.0;
-        double throughput = actual_ops.load() / (elapsed_ms / 1000.0);
-        
-        double speedup = 1.0;
-        if (thread_count == 1) {
-            base_throughput = throughput;
-        } else {
-            speedup = throughput / base_throughput;
-        }
-        
-        std::cout << "| " << std::setw(7) << thread_count 
-                  << " | " << std::setw(12) << std::fixed << std::setprecision(2) << elapsed_ms 
-                  << " | " << std::setw(18) << std::fixed << std::setprecision(2) << throughput 
-                  << " | " << std::setw(7) << std::fixed << std::setprecision(2) << speedup 
-                  << " |\n";
-        
-        deleteMSQueue(q);
+        });
     }
-    
-    std::cout << "---------------------------------------------------------\n";
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (order_errors.load() != 0) {
+        std::cerr << "FAIL: " << order_errors.load() << " struct payloads came back torn or missing\n";
+    } else {
+        std::cout << "PASS: " << order_threads * orders_per_thread << " struct payloads round-tripped intact\n";
+    }
+    deleteMSQueue(orders);
 }
 
-void compare_with_boost(size_t thread_count, size_t op_count, int enq_probability = 50) {
-    std::cout << "\n=== Comparing MS Queue with Boost Queue ===\n";
-    std::cout << "Threads: " << thread_count << ", Operations per thread: " << op_count 
-              << ", Enqueue probability: " << enq_probability << "%\n";
-    
-    std::vector<uint32_t> enq_values;
-    size_t total_ops = thread_count * op_count;
-    size_t expected_enqueues = total_ops * enq_probability / 100;
-    
-    std::string file_path = "bin/random_values_insert.bin";
-    if (std::filesystem::exists(file_path)) {
-        enq_values = read_binary_data(file_path, expected_enqueues);
+void test_faa_queue() {
+    std::cout << "\nStarting FAA segmented queue tests...\n";
+    const int num_producers = 4;
+    const int num_consumers = 4;
+    const int items_per_producer = 50000;
+    const int total_items = num_producers * items_per_producer;
+    std::vector<std::atomic<int>> seen(total_items);
+    int value = 0;
+    FAAQueue* fq = createFAAQueue();
+    enq(fq, -1);
+    enq(fq, 0);
+    bool faa_single_ok = try_dequeue(fq, value) && value == -1 && try_dequeue(fq, value) && value == 0 &&
+                         !try_dequeue(fq, value);
+    if (!faa_single_ok) {
+        std::cerr << "FAIL: FAA queue returned the wrong values single-threaded\n";
     } else {
-        std::cout << "Warning: Binary file not found. Using generated values instead.\n";
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<uint32_t> dis(1, 1000000);
-        
-        enq_values.resize(expected_enqueues);
-        for (auto& val : enq_values) {
-            val = dis(gen);
-        }
+        std::cout << "PASS: FAA queue keeps FIFO order for -1 and 0 and reports empty\n";
     }
     
-    MSQueue* ms_queue = createMSQueue();
-    std::atomic<size_t> ms_enq_index(0);
-    std::atomic<size_t> ms_actual_ops(0);
-    
-    auto ms_worker = [&](int thread_id) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> op_dis(0, 99);
-        
-        for (size_t i = 0; i < op_count; i++) {
-            if (op_dis(gen) < enq_probability) {
-                size_t idx = ms_enq_index.fetch_add(1, std::memory_order_relaxed);
-                int value = (idx < enq_values.size()) ? enq_values[idx] : thread_id * 1000 + i;
-                enq(ms_queue, value);
-            } else {
-                deq(ms_queue);
+    std::atomic<int> consumed(0);
+    std::atomic<bool> order_ok(true);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < num_producers; p++) {
+        threads.emplace_back([&fq, p, items_per_producer]() {
+            for (int j = 0; j < items_per_producer; j++) {
+                enq(fq, p * items_per_producer + j);
             }
-            ms_actual_ops.fetch_add(1, std::memory_order_relaxed);
-        }
-    };
-    
-    auto ms_start_time = HR::now();
-    
-    std::vector<std::thread> ms_threads;
-    for (size_t i = 0; i < thread_count; i++) {
-        ms_threads.emplace_back(ms_worker, i);
+        });
+    }
+    for (int c = 0; c < num_consumers; c++) {
+        threads.emplace_back([&]() {
+            std::vector<int> last_from(num_producers, -1);
+            int item;
+            while (consumed.load(std::memory_order_relaxed) < total_items) {
+                if (!try_dequeue(fq, item)) continue;
+                seen[item].fetch_add(1, std::memory_order_relaxed);
+                int producer = item / items_per_producer;
+                if (item <= last_from[producer]) {
+                    order_ok.store(false, std::memory_order_relaxed);
+                }
+                last_from[producer] = item;
+                consumed.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
     }
     
-    for (auto& t : ms_threads) {
+    for (auto& t : threads) {
         t.join();
     }
     
-    auto ms_end_time = HR::now();
-    auto ms_elapsed = std::chrono::duration_cast<std::chrono::microseconds>(ms_end_time - ms_start_time);
-    double ms_elapsed_ms = ms_elapsed.count() / 1000.0;
-    double ms_throughput = ms_actual_ops.load() / (ms_elapsed_ms / 1000.0);
+    int duplicates_or_lost = 0;
+    for (int i = 0; i < total_items; i++) {
+        if (seen[i].load() != 1) duplicates_or_lost++;
+    }
     
-    boost::lockfree::queue<int> boost_queue(1000);
-    std::atomic<size_t> boost_enq_index(0);
-    std::atomic<size_t> boost_actual_ops(0);
+    if (duplicates_or_lost != 0 || !order_ok.load()) {
+        std::cerr << "FAIL: FAA queue lost, duplicated or reordered " << duplicates_or_lost << " values\n";
+    } else {
+        std::cout << "PASS: All " << total_items << " values crossed " 
+                  << total_items / FAASegment::CELLS << "+ segments exactly once in producer order\n";
+    }
+    std::cout << "Segments reclaimed: " << fq->hazards->reclaimed() 
+              << ", still pending: " << fq->hazards->pending() << "\n";
+    deleteFAAQueue(fq);
+}
+
+void test_bounded_ring() {
+    std::cout << "\nStarting bounded ring tests...\n";
+    const int num_producers = 4;
+    const int num_consumers = 4;
+    const int items_per_producer = 50000;
+    const int total_items = num_producers * items_per_producer;
+    std::vector<std::atomic<int>> seen(total_items);
+    int value = 0;
+    BoundedQueue<int>* ring = createBoundedQueue<int>(6);
+    size_t accepted = 0;
+    while (try_enqueue(ring, static_cast<int>(accepted))) {
+        accepted++;
+    }
+    bool ring_ok = accepted == capacityOf(ring) && capacityOf(ring) == 8;
+    for (int i = 0; i < 3; i++) {
+        ring_ok = ring_ok && try_dequeue(ring, value) && value == i;
+    }
+    int ring_batch[8] = {100, 101, 102, 103, 104, 105, 106, 107};
+    ring_ok = ring_ok && try_enqueue_bulk(ring, ring_batch, 8) == 3;
+    int ring_out[16];
+    size_t drained = try_dequeue_bulk(ring, ring_out, 16);
+    ring_ok = ring_ok && drained == 8 && ring_out[0] == 3 && ring_out[4] == 7 && ring_out[5] == 100 && ring_out[7] == 102;
+    ring_ok = ring_ok && !try_dequeue(ring, value) && try_dequeue_bulk(ring, ring_out, 16) == 0;
+    if (!ring_ok) {
+        std::cerr << "FAIL: Bounded ring mishandled full, wraparound or batch operations\n";
+    } else {
+        std::cout << "PASS: Bounded ring rejects when full, wraps around and batches partially\n";
+    }
+    deleteBoundedQueue(ring);
     
-    auto boost_worker = [&](int thread_id) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> op_dis(0, 99);
-        
-        for (size_t i = 0; i < op_count; i++) {
-            if (op_dis(gen) < enq_probability) {
-                size_t idx = boost_enq_index.fetch_add(1, std::memory_order_relaxed);
-                int value = (idx < enq_values.size()) ? enq_values[idx] : thread_id * 1000 + i;
-                boost_queue.push(value);
-            } else {
-                int value;
-                boost_queue.pop(value);
+    ring = createBoundedQueue<int>(64);
+    std::atomic<size_t> full_rejections(0);
+    std::atomic<int> consumed(0);
+    std::atomic<bool> order_ok(true);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < num_producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (int j = 0; j < items_per_producer; j++) {
+                while (!try_enqueue(ring, p * items_per_producer + j)) {
+                    full_rejections.fetch_add(1, std::memory_order_relaxed);
+                    std::this_thread::yield();
+                }
             }
-            boost_actual_ops.fetch_add(1, std::memory_order_relaxed);
-        }
-    };
-    
-    auto boost_start_time = HR::now();
-    
-    std::vector<std::thread> boost_threads;
-    for (size_t i = 0; i < thread_count; i++) {
-        boost_threads.emplace_back(boost_worker, i);
+        });
+    }
+    for (int c = 0; c < num_consumers; c++) {
+        threads.emplace_back([&, c]() {
+            std::vector<int> last_from(num_producers, -1);
+            int batch[16];
+            while (consumed.load(std::memory_order_relaxed) < total_items) {
+                size_t n = (c % 2 == 0) ? try_dequeue_bulk(ring, batch, 16)
+                                        : (try_dequeue(ring, batch[0]) ? 1 : 0);
+                for (size_t k = 0; k < n; k++) {
+                    int item = batch[k];
+                    seen[item].fetch_add(1, std::memory_order_relaxed);
+                    int producer = item / items_per_producer;
+                    if (item <= last_from[producer]) {
+                        order_ok.store(false, std::memory_order_relaxed);
+                    }
+                    last_from[producer] = item;
+                }
+                consumed.fetch_add(n, std::memory_order_relaxed);
+            }
+        });
     }
     
-    for (auto& t : boost_threads) {
+    for (auto& t : threads) {
         t.join();
     }
     
-    auto boost_end_time = HR::now();
-    auto boost_elapsed = std::chrono::duration_cast<std::chrono::microseconds>(boost_end_time - boost_start_time);
-    double boost_elapsed_ms = boost_elapsed.count() / 1000.0;
-    double boost_throughput = boost_actual_ops.load() / (boost_elapsed_ms / 1000.0);
-    
-    std::cout << "\nComparison Results:\n";
-    std::cout << "--------------------------------------------------------\n";
-    std::cout << "| Implementation |   Time (ms)  | Throughput (ops/s)   |\n";
-    std::cout << "--------------------------------------------------------\n";
-    std::cout << "| MS Queue       | " << std::setw(12) << std::fixed << std::setprecision(2) << ms_elapsed_ms 
-              << " | " << std::setw(20) << std::fixed << std::setprecision(2) << ms_throughput << " |\n";
-    std::cout << "| Boost Queue    | " << std::setw(12) << std::fixed << std::setprecision(2) << boost_elapsed_ms 
-              << " | " << std::setw(20) << std::fixed << std::setprecision(2) << boost_throughput << " |\n";
-    std::cout << "--------------------------------------------------------\n";
+    int duplicates_or_lost = 0;
+    for (int i = 0; i < total_items; i++) {
+        if (seen[i].load() != 1) duplicates_or_lost++;
+    }
     
-    double relative_perf = ms_throughput / boost_throughput;
-    if (relative_perf > 1.0) {
-        std::cout << "MS Queue is " << std::fixed << std::setprecision(2) << relative_perf 
-                  << "x faster than Boost Queue\n";
+    if (duplicates_or_lost != 0 || !order_ok.load()) {
+        std::cerr << "FAIL: Bounded ring lost, duplicated or reordered " << duplicates_or_lost << " values\n";
     } else {
-        std::cout << "MS Queue is " << std::fixed << std::setprecision(2) << (1.0 / relative_perf) 
-                  << "x slower than Boost Queue\n";
+        std::cout << "PASS: All " << total_items << " values passed through a 64-slot ring exactly once (" 
+                  << full_rejections.load() << " full rejections)\n";
     }
-    
-    deleteMSQueue(ms_queue);
+    deleteBoundedQueue(ring);
 }
 
-void run_workload_tests() {
-    std::cout << "\n=== Running Workload Size Tests ===\n";
+void test_role_queues() {
+    std::cout << "\nStarting single-producer/single-consumer queue tests...\n";
+    const int num_producers = 4;
+    const int items_per_producer = 50000;
+    const int total_items = num_producers * items_per_producer;
+    std::vector<std::atomic<int>> seen(total_items);
+    int value = 0;
+    RoleQueue<int, SingleProducer, SingleConsumer>* spsc = createRoleQueue<int, SingleProducer, SingleConsumer>(16);
+    const int spsc_items = 200000;
+    std::atomic<bool> spsc_ok(true);
+    std::thread spsc_producer([&]() {
+        for (int j = 0; j < spsc_items; j++) {
+            while (!try_enqueue(spsc, j)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::thread spsc_consumer([&]() {
+        int item;
+        for (int expected = 0; expected < spsc_items; ) {
+            if (!try_dequeue(spsc, item)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (item != expected) spsc_ok.store(false, std::memory_order_relaxed);
+            expected++;
+        }
+    });
+    spsc_producer.join();
+    spsc_consumer.join();
+    if (!spsc_ok.load() || try_dequeue(spsc, value)) {
+        std::cerr << "FAIL: SPSC ring lost or reordered values\n";
+    } else {
+        std::cout << "PASS: SPSC ring delivered " << spsc_items << " values in order through 16 slots\n";
+    }
+    deleteRoleQueue<int, SingleProducer, SingleConsumer>(spsc);
     
-    std::vector<size_t> workload_sizes = {100000, 1000000, 10000000};
+    RoleQueue<int, MultiProducer, SingleConsumer>* mpsc = createRoleQueue<int, MultiProducer, SingleConsumer>();
+    static_assert(std::is_same<RoleQueue<int, MultiProducer, MultiConsumer>, MSQueue<int>>::value,
+                  "MPMC roles fall back to MSQueue");
+    std::atomic<bool> order_ok(true);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < num_producers; p++) {
+        threads.emplace_back([&mpsc, p, items_per_producer]() {
+            for (int j = 0; j < items_per_producer; j++) {
+                enq(mpsc, p * items_per_producer + j);
+            }
+        });
+    }
+    threads.emplace_back([&]() {
+        std::vector<int> last_from(num_producers, -1);
+        int item;
+        for (int got = 0; got < total_items; ) {
+            if (!try_dequeue(mpsc, item)) continue;
+            seen[item].fetch_add(1, std::memory_order_relaxed);
+            int producer = item / items_per_producer;
+            if (item <= last_from[producer]) {
+                order_ok.store(false, std::memory_order_relaxed);
+            }
+            last_from[producer] = item;
+            got++;
+        }
+    });
     
-    for (size_t workload : workload_sizes) {
-        std::cout << "\nTesting workload size: " << workload << " operations\n";
-        
-        const size_t thread_count = 4;
-        size_t ops_per_thread = workload / thread_count;
-        
-        run_performance_test(thread_count, ops_per_thread);
+    for (auto& t : threads) {
+        t.join();
     }
-}
-
-void show_usage() {
-    std::cout << "Usage: ./problem2 <test_type> [options]\n\n";
-    std::cout << "Test types:\n";
-    std::cout << "  correctness    - Run correctness tests\n";
-    std::cout << "  performance    - Run performance test (default)\n";
-    std::cout << "  scalability    - Run scalability test with varying thread counts\n";
-    std::cout << "  boost          - Compare with Boost's lock-free queue\n";
-    std::cout << "  workload       - Test with different workload sizes\n";
-    std::cout << "  all            - Run all tests\n\n";
     
-    std::cout << "Options:\n";
-    std::cout << "  --threads <n>  - Set number of threads (default: 4)\n";
-    std::cout << "  --ops <n>      - Set operations per thread (default: 1000000)\n";
-    std::cout << "  --enq-prob <n> - Set enqueue probability percent (default: 50)\n";
+    int duplicates_or_lost = 0;
+    for (int i = 0; i < total_items; i++) {
+        if (seen[i].load() != 1) duplicates_or_lost++;
+    }
+    if (duplicates_or_lost != 0 || !order_ok.load()) {
+        std::cerr << "FAIL: MPSC queue lost, duplicated or reordered " << duplicates_or_lost << " values\n";
+    } else {
+        std::cout << "PASS: MPSC queue delivered all " << total_items << " values from " 
+                  << num_producers << " producers exactly once in producer order\n";
+    }
+    deleteRoleQueue<int, MultiProducer, SingleConsumer>(mpsc);
+}
+
+void test_blocking_dequeue() {
+    std::cout << "\nStarting blocking dequeue tests...\n";
+    const int num_producers = 4;
+    const int num_consumers = 4;
+    const int items_per_producer = 50000;
+    const int total_items = num_producers * items_per_producer;
+    std::vector<std::atomic<int>> seen(total_items);
+    int value = 0;
+    MSQueue<int>* q = createMSQueue();
+    auto wait_start = std::chrono::steady_clock::now();
+    bool timed_out = !dequeue_wait_for(q, value, std::chrono::milliseconds(20));
+    auto waited = std::chrono::steady_clock::now() - wait_start;
+    if (!timed_out || waited < std::chrono::milliseconds(20)) {
+        std::cerr << "FAIL: dequeue_wait_for on an empty queue did not wait out its timeout\n";
+    } else {
+        std::cout << "PASS: dequeue_wait_for timed out after " 
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(waited).count() << " ms\n";
+    }
+    
+    std::vector<std::thread> threads;
+    for (int c = 0; c < num_consumers; c++) {
+        threads.emplace_back([&]() {
+            int item;
+            while (true) {
+                dequeue_wait(q, item);
+                if (item < 0) break;
+                seen[item].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (int p = 0; p < num_producers; p++) {
+        threads.emplace_back([&q, p, items_per_producer]() {
+            for (int j = 0; j < items_per_producer; j++) {
+                enq(q, p * items_per_producer + j);
+                if (j % 4096 == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+        });
+    }
+    for (int p = 0; p < num_producers; p++) {
+        threads[num_consumers + p].join();
+    }
+    for (int c = 0; c < num_consumers; c++) {
+        enq(q, -1);
+    }
+    for (int c = 0; c < num_consumers; c++) {
+        threads[c].join();
+    }
+    
+    int duplicates_or_lost = 0;
+    for (int i = 0; i < total_items; i++) {
+        if (seen[i].load() != 1) duplicates_or_lost++;
+    }
+    if (duplicates_or_lost != 0) {
+        std::cerr << "FAIL: Blocking consumers lost or duplicated " << duplicates_or_lost << " values\n";
+    } else {
+        std::cout << "PASS: Blocking consumers received all " << total_items << " values exactly once and woke for shutdown\n";
+    }
+    deleteMSQueue(q);
+}
+
+void test_coroutine_consumers() {
+    std::cout << "\nStarting coroutine consumer tests...\n";
+    MSQueue<int>* q = createMSQueue();
+    LoopExecutor executor;
+    const int coro_items = 20000;
+    std::vector<std::atomic<int>> coro_seen(coro_items);
+    std::atomic<size_t> coro_done(0);
+    
+    // Half the values are queued before anyone waits, half are handed to
+    // coroutines that are already suspended.
+    for (int i = 0; i < coro_items / 2; i++) {
+        enq(q, i);
+    }
+    for (int i = 0; i < coro_items; i++) {
+        consume_one(q, &executor, &coro_seen, &coro_done);
+    }
+    size_t immediate = coro_done.load();
+    size_t parked_nodes = countQueue(q);
+    
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 2; p++) {
+        threads.emplace_back([&q, p, coro_items]() {
+            for (int i = coro_items / 2 + p; i < coro_items; i += 2) {
+                enq(q, i);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    executor.run_pending();
+    
+    int coro_errors = 0;
+    for (int i = 0; i < coro_items; i++) {
+        if (coro_seen[i].load() != 1) coro_errors++;
+    }
+    if (immediate != static_cast<size_t>(coro_items / 2) || parked_nodes != 0 || 
+        coro_errors != 0 || coro_done.load() != static_cast<size_t>(coro_items) || countQueue(q) != 0) {
+        std::cerr << "FAIL: Coroutine consumers lost, duplicated or stranded values (" << coro_errors << " bad)\n";
+    } else {
+        std::cout << "PASS: " << coro_items << " coroutine consumers each received one value, " 
+                  << coro_items / 2 << " of them by direct hand-off\n";
+    }
+    deleteMSQueue(q);
+    threads.clear();
+    
+    // Waiters pile up while producers run, so direct hand-offs, queued values and
+    // waiters that find the queue empty all interleave. Suspended waiters must be
+    // served in the order they suspended: with one producer the values they get
+    // rise globally, with four they rise per producer.
+    for (int fifo_producers : {1, 4}) {
+        MSQueue<int>* fq = createMSQueue();
+        const int per_producer = 20000 / fifo_producers;
+        const int fifo_items = per_producer * fifo_producers;
+        std::vector<int> received(fifo_items, -1);
+        std::vector<int> suspended(fifo_items, 0);
+        bool draining = false;
+        std::atomic<size_t> fifo_done(0);
+        auto drain = [&]() {
+            draining = true;
+            executor.run_pending();
+            draining = false;
+        };
+        
+        // Producers alternate between running 64 values ahead of the consumer and
+        // 64 behind it, so some coroutines find a value and others wait for one.
+        std::atomic<int> started(0);
+        for (int p = 0; p < fifo_producers; p++) {
+            threads.emplace_back([fq, p, fifo_producers, per_producer, fifo_items, &started]() {
+                for (int j = 0; j < per_producer; j++) {
+                    int g = j * fifo_producers + p;
+                    int wait_for = std::min(fifo_items, g + ((g / 512) % 2 ? 64 : -64));
+                    while (started.load() < wait_for) {
+                        std::this_thread::yield();
+                    }
+                    enq(fq, p * per_producer + j);
+                }
+            });
+        }
+        for (int i = 0; i < fifo_items; i++) {
+            consume_in_order(fq, &executor, &draining, &received[i], &suspended[i], &fifo_done);
+            started.store(i + 1);
+            if (i % 16 == 15) {
+                drain();
+                std::this_thread::yield();
+            }
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        threads.clear();
+        while (fifo_done.load() < static_cast<size_t>(fifo_items)) {
+            drain();
+        }
+        
+        std::vector<int> counts(fifo_items, 0);
+        std::vector<int> last(fifo_producers, -1);
+        int out_of_order = 0;
+        int waited = 0;
+        for (int i = 0; i < fifo_items; i++) {
+            counts[received[i]]++;
+            if (!suspended[i]) continue;
+            waited++;
+            int p = received[i] / per_producer;
+            if (received[i] < last[p]) out_of_order++;
+            last[p] = received[i];
+        }
+        int fifo_lost = 0;
+        for (int c : counts) {
+            if (c != 1) fifo_lost++;
+        }
+        if (out_of_order != 0 || fifo_lost != 0 || countQueue(fq) != 0) {
+            std::cerr << "FAIL: Suspended coroutines were served out of order (" << out_of_order 
+                      << ") or values were lost (" << fifo_lost << ") with " << fifo_producers << " producer(s)\n";
+        } else {
+            std::cout << "PASS: " << waited << " suspended coroutines got values in FIFO order with " 
+                      << fifo_producers << " producer(s)\n";
+        }
+        deleteMSQueue(fq);
+    }
+}
+
+void test_backoff() {
+    std::cout << "\nStarting backoff tests...\n";
+    for (BackoffPolicy policy : {BackoffPolicy::Exponential, BackoffPolicy::Randomized}) {
+        MSQueueConfig config;
+        config.backoff = policy;
+        MSQueue<int>* q = createMSQueue(config);
+        const int backoff_threads = 4;
+        const int backoff_items = 20000;
+        std::atomic<long long> backoff_sum(0);
+        std::atomic<int> backoff_taken(0);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < backoff_threads; t++) {
+            threads.emplace_back([&q, &backoff_sum, &backoff_taken, t, backoff_items]() {
+                for (int i = 0; i < backoff_items; i++) {
+                    enq(q, t * backoff_items + i);
+                    int value;
+                    if (try_dequeue(q, value)) {
+                        backoff_sum += value;
+                        backoff_taken++;
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        int value;
+        while (try_dequeue(q, value)) {
+            backoff_sum += value;
+            backoff_taken++;
+        }
+
+        // Every successful enq or deq ends with exactly one winning CAS.
+        long long n = static_cast<long long>(backoff_threads) * backoff_items;
+        ContentionStats stats = contentionStats(q);
+        uint64_t successes = stats.cas_attempts - stats.cas_failures;
+        if (backoff_taken.load() != n || backoff_sum.load() != n * (n - 1) / 2 ||
+            successes != static_cast<uint64_t>(2 * n)) {
+            std::cerr << "FAIL: " << backoffName(policy) << " backoff lost values or miscounted CASes\n";
+        } else {
+            std::cout << "PASS: " << backoffName(policy) << " backoff delivered all " << n
+                      << " values, CAS failure rate " << std::fixed << std::setprecision(2)
+                      << stats.failureRate() * 100 << "%\n";
+        }
+        deleteMSQueue(q);
+    }
+}
+
+void test_flat_combining() {
+    std::cout << "\nStarting flat-combining queue tests...\n";
+    // Starts tiny so the combiner has to grow the ring while full.
+    FCQueue<int>* fq = createFCQueue<int>(4);
+    bool fc_fifo = deq(fq) == -1;
+    for (int i = 0; i < 100; i++) {
+        enq(fq, i);
+    }
+    for (int i = 0; i < 100; i++) {
+        fc_fifo = fc_fifo && deq(fq) == i;
+    }
+    fc_fifo = fc_fifo && deq(fq) == -1 && countQueue(fq) == 0;
+
+    const int fc_threads = 4;
+    const int fc_items = 20000;
+    std::atomic<long long> fc_sum(0);
+    std::atomic<int> fc_taken(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < fc_threads; t++) {
+        threads.emplace_back([&fq, &fc_sum, &fc_taken, t, fc_items]() {
+            for (int i = 0; i < fc_items; i++) {
+                enq(fq, t * fc_items + i);
+                int value = deq(fq);
+                if (value != -1) {
+                    fc_sum += value;
+                    fc_taken++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (int value = deq(fq); value != -1; value = deq(fq)) {
+        fc_sum += value;
+        fc_taken++;
+    }
+    deleteFCQueue(fq);
+
+    FCQueue<std::unique_ptr<std::string>>* sq = createFCQueue<std::unique_ptr<std::string>>();
+    enq(sq, new std::string("combined"));
+    std::unique_ptr<std::string> text;
+    bool fc_move = try_dequeue(sq, text) && text && *text == "combined" && !try_dequeue(sq, text);
+    enq(sq, new std::string("left behind"));
+    deleteFCQueue(sq);
+
+    long long n = static_cast<long long>(fc_threads) * fc_items;
+    if (!fc_fifo || !fc_move || fc_taken.load() != n || fc_sum.load() != n * (n - 1) / 2) {
+        std::cerr << "FAIL: Flat-combining queue lost, reordered or duplicated values\n";
+    } else {
+        std::cout << "PASS: Flat-combining queue kept FIFO order, grew its ring and delivered all "
+                  << n << " concurrent values once\n";
+    }
+}
+
+void test_size_estimate() {
+    std::cout << "\nStarting size estimate tests...\n";
+    MSQueue<int>* q = createMSQueue();
+    const int size_threads = 4;
+    const int size_rounds = 5000;
+    std::atomic<bool> size_running(true);
+    std::atomic<size_t> size_max_seen(0);
+
+    // A monitor samples while the workers churn; it must never see more
+    // values than could have been enqueued.
+    std::thread monitor([&q, &size_running, &size_max_seen]() {
+        while (size_running.load()) {
+            size_t seen = size_approx(q);
+            if (seen > size_max_seen.load()) size_max_seen.store(seen);
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < size_threads; t++) {
+        threads.emplace_back([&q, t, size_rounds]() {
+            int burst[4] = {t, t, t, t};
+            int out[4];
+            for (int i = 0; i < size_rounds; i++) {
+                enq(q, i);
+                enq_bulk(q, burst, 4);
+                int value;
+                try_dequeue(q, value);
+                deq_bulk(q, out, 3);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    size_running.store(false);
+    monitor.join();
+
+    size_t exact = countQueue(q);
+    bool size_ok = size_approx(q) == exact &&
+                   size_max_seen.load() <= static_cast<size_t>(size_threads) * size_rounds * 5;
+
+    const int filled = 1000000;
+    for (int i = 0; i < filled; i++) {
+        enq(q, i);
+    }
+    auto walk_start = HR::now();
+    size_t walked = countQueue(q);
+    auto walk_end = HR::now();
+    size_t estimated = size_approx(q);
+    auto estimate_end = HR::now();
+    size_ok = size_ok && walked == estimated && estimated == exact + filled;
+
+    if (!size_ok) {
+        std::cerr << "FAIL: size_approx disagreed with countQueue (" << size_approx(q) << " vs "
+                  << countQueue(q) << ")\n";
+    } else {
+        std::cout << "PASS: size_approx matched countQueue at " << estimated << " values ("
+                  << std::chrono::duration_cast<std::chrono::microseconds>(estimate_end - walk_end).count()
+                  << " us vs "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(walk_end - walk_start).count()
+                  << " us for the walk)\n";
+    }
+    deleteMSQueue(q);
+}
+
+void test_multi_queue() {
+    std::cout << "\nStarting multi-queue tests...\n";
+    MultiQueue<int>* mq = createMultiQueue<int>(8);
+    bool mq_ok = deq(mq) == -1;
+    // One thread uses one lane, so its own values come back in FIFO order.
+    for (int i = 0; i < 100; i++) {
+        enq(mq, i);
+    }
+    for (int i = 0; i < 100; i++) {
+        mq_ok = mq_ok && deq(mq) == i;
+    }
+
+    // Values left on this thread's lane can only be reached by stealing.
+    const int stranded = 1000;
+    for (int i = 0; i < stranded; i++) {
+        enq(mq, i);
+    }
+    std::atomic<int> stolen(0);
+    std::thread thief([&mq, &stolen]() {
+        while (deq(mq) != -1) stolen++;
+    });
+    thief.join();
+    mq_ok = mq_ok && stolen.load() == stranded;
+
+    const int mq_threads = 4;
+    const int mq_items = 20000;
+    std::atomic<long long> mq_sum(0);
+    std::atomic<int> mq_taken(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < mq_threads; t++) {
+        threads.emplace_back([&mq, &mq_sum, &mq_taken, t, mq_items]() {
+            for (int i = 0; i < mq_items; i++) {
+                enq(mq, t * mq_items + i);
+                if (i % 2 == 0) {
+                    int value = deq(mq);
+                    if (value != -1) {
+                        mq_sum += value;
+                        mq_taken++;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (int value = deq(mq); value != -1; value = deq(mq)) {
+        mq_sum += value;
+        mq_taken++;
+    }
+    long long n = static_cast<long long>(mq_threads) * mq_items;
+    mq_ok = mq_ok && mq_taken.load() == n && mq_sum.load() == n * (n - 1) / 2 && size_approx(mq) == 0;
+    deleteMultiQueue(mq);
+
+    if (!mq_ok) {
+        std::cerr << "FAIL: MultiQueue lost, duplicated or misordered values\n";
+    } else {
+        std::cout << "PASS: MultiQueue kept per-lane FIFO order, stole " << stranded
+                  << " values from another lane and delivered all " << n << " concurrent values once\n";
+    }
+}
+
+void test_ws_deque() {
+    std::cout << "\nStarting work-stealing deque tests...\n";
+    WSDeque<int>* wd = createWSDeque<int>(4);
+    bool ws_order = true;
+    int value;
+    for (int i = 0; i < 10; i++) {
+        wsPush(wd, i);
+    }
+    ws_order = ws_order && wsSteal(wd, value) && value == 0;
+    ws_order = ws_order && wsPop(wd, value) && value == 9;
+    ws_order = ws_order && wsSteal(wd, value) && value == 1;
+    while (wsPop(wd, value)) {
+    }
+    ws_order = ws_order && wsSize(wd) == 0 && !wsSteal(wd, value);
+
+    // The owner pushes and pops while thieves steal; the array starts at four
+    // slots so it has to grow under the thieves.
+    const int ws_items = 200000;
+    const int thieves = 3;
+    std::vector<std::atomic<int>> ws_seen(ws_items);
+    std::atomic<bool> owner_done(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thieves; t++) {
+        threads.emplace_back([&wd, &ws_seen, &owner_done]() {
+            int stolen;
+            while (!owner_done.load()) {
+                if (wsSteal(wd, stolen)) {
+                    ws_seen[stolen]++;
+                }
+            }
+            while (wsSteal(wd, stolen)) {
+                ws_seen[stolen]++;
+            }
+        });
+    }
+    for (int i = 0; i < ws_items; i++) {
+        wsPush(wd, i);
+        if (i % 3 == 0 && wsPop(wd, value)) {
+            ws_seen[value]++;
+        }
+    }
+    while (wsPop(wd, value)) {
+        ws_seen[value]++;
+    }
+    owner_done.store(true);
+    for (auto& t : threads) {
+        t.join();
+    }
+    deleteWSDeque(wd);
+
+    int ws_errors = 0;
+    for (int i = 0; i < ws_items; i++) {
+        if (ws_seen[i].load() != 1) ws_errors++;
+    }
+    if (!ws_order || ws_errors != 0) {
+        std::cerr << "FAIL: Work-stealing deque misordered, lost or duplicated values (" << ws_errors << " bad)\n";
+    } else {
+        std::cout << "PASS: Work-stealing deque popped LIFO, stole FIFO, grew under " << thieves
+                  << " thieves and delivered all " << ws_items << " values once\n";
+    }
+}
+
+void test_thread_pool() {
+    std::cout << "\nStarting thread-pool executor tests...\n";
+    for (IdlePolicy idle : {IdlePolicy::Spin, IdlePolicy::Park}) {
+        ThreadPoolConfig config;
+        config.workers = 4;
+        config.idle = idle;
+        config.spin_rounds = 64;
+        ThreadPool* pool = createThreadPool(config);
+        
+        WaitGroup wg;
+        std::atomic<int> ran(0);
+        const int pool_tasks = 10000;
+        for (int i = 0; i < pool_tasks; i++) {
+            wait_group_add(&wg, 1);
+            submit(pool, [&wg, &ran]() {
+                ran++;
+                wait_group_done(&wg);
+            });
+        }
+        wait_group_wait(pool, &wg);
+        
+        // Let parked workers fall asleep, then check a submit still wakes one.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::atomic<bool> woke(false);
+        wait_group_add(&wg, 1);
+        submit(pool, [&wg, &woke]() {
+            woke = true;
+            wait_group_done(&wg);
+        });
+        auto wake_deadline = HR::now() + std::chrono::seconds(2);
+        while (!woke.load() && HR::now() < wake_deadline) {
+            std::this_thread::yield();
+        }
+        wait_group_wait(pool, &wg);
+        
+        // A parallel_for inside a task waits by running other tasks, not blocking.
+        const size_t pf_range = 100000;
+        std::vector<std::atomic<int>> pf_hits(pf_range);
+        WaitGroup outer;
+        wait_group_add(&outer, 1);
+        submit(pool, [pool, &pf_hits, &outer, pf_range]() {
+            parallel_for(pool, 0, pf_range, 100, [&pf_hits](size_t i) { pf_hits[i]++; });
+            wait_group_done(&outer);
+        });
+        wait_group_wait(pool, &outer);
+        deleteThreadPool(pool);
+        
+        int pf_errors = 0;
+        for (size_t i = 0; i < pf_range; i++) {
+            if (pf_hits[i].load() != 1) pf_errors++;
+        }
+        const char* idle_name = idle == IdlePolicy::Spin ? "spinning" : "parking";
+        if (ran.load() != pool_tasks || !woke.load() || pf_errors != 0) {
+            std::cerr << "FAIL: Executor with " << idle_name << " workers ran " << ran.load() << "/" << pool_tasks 
+                      << " tasks, wake " << woke.load() << ", " << pf_errors << " bad parallel_for indices\n";
+        } else {
+            std::cout << "PASS: Executor with " << idle_name << " workers ran " << pool_tasks 
+                      << " tasks, woke for a late submit and ran a nested parallel_for\n";
+        }
+    }
+}
+
+void test_bench_harness() {
+    std::cout << "\nStarting benchmark harness tests...\n";
+    BenchConfig config;
+    config.threads = 4;
+    config.ops_per_thread = 5000;
+    std::vector<std::vector<int32_t>> schedules = buildSchedules(config, std::vector<uint32_t>());
+    uint64_t scheduled_enqueues = 0;
+    for (const auto& ops : schedules) {
+        scheduled_enqueues += std::count_if(ops.begin(), ops.end(), [](int32_t op) { return op != BENCH_DEQ; });
+    }
+
+    MSQueue<int>* q = createMSQueue();
+    BenchResult mixed = runBenchmark(config, schedules,
+        [&q](int32_t value) { enq(q, static_cast<int>(value)); },
+        [&q]() { return deq(q) != -1; });
+    bool harness_ok = mixed.enqueues == scheduled_enqueues &&
+                      mixed.operations() == 4 * 5000 &&
+                      mixed.enqueues - mixed.dequeues == static_cast<uint64_t>(countQueue(q));
+    deleteMSQueue(q);
+
+    config.producers = 1;
+    config.consumers = 2;
+    config.duration = std::chrono::milliseconds(50);
+    schedules = buildSchedules(config, std::vector<uint32_t>());
+    q = createMSQueue();
+    BenchResult timed = runBenchmark(config, schedules,
+        [&q](int32_t value) { enq(q, static_cast<int>(value)); },
+        [&q]() { return deq(q) != -1; });
+    harness_ok = harness_ok && timed.elapsed_ms >= 50 && timed.enqueues > 0 &&
+                 timed.enqueues - timed.dequeues == static_cast<uint64_t>(countQueue(q));
+    deleteMSQueue(q);
+
+    if (!harness_ok) {
+        std::cerr << "FAIL: Benchmark harness miscounted operations\n";
+    } else {
+        std::cout << "PASS: Benchmark harness replayed mixed schedules exactly and ran producer/consumer roles for "
+                  << std::fixed << std::setprecision(1) << timed.elapsed_ms << " ms\n";
+    }
+}
+
+void test_latency_histogram() {
+    std::cout << "\nStarting latency histogram tests...\n";
+    LatencyHistogram low, high;
+    for (uint64_t v = 1; v <= 10000; v++) {
+        (v <= 5000 ? low : high).record(v);
+    }
+    low.merge(high);
+    // Each reported percentile is the top of a bucket at most 1/32 wide.
+    auto close_to = [](uint64_t reported, uint64_t exact) {
+        return reported >= exact && reported <= exact + exact / 32;
+    };
+    if (low.count() != 10000 || low.max() != 10000 || low.percentile(0) != 1 || low.percentile(100) != 10000 ||
+        !close_to(low.percentile(50), 5000) || !close_to(low.percentile(99), 9900) ||
+        !close_to(low.percentile(99.99), 9999)) {
+        std::cerr << "FAIL: Latency histogram percentiles off: p50=" << low.percentile(50) 
+                  << " p99=" << low.percentile(99) << " p99.99=" << low.percentile(99.99) << "\n";
+    } else {
+        std::cout << "PASS: Merged latency histogram reports percentiles within one bucket (p50=" 
+                  << low.percentile(50) << ", p99=" << low.percentile(99) << ")\n";
+    }
+}
+
+void test_lock_queues() {
+    std::cout << "\nStarting lock-based baseline queue tests...\n";
+    // Same checks for both: FIFO order alone, then every value delivered
+    // once while threads enqueue and dequeue concurrently.
+    auto check_queue = [](auto* lq) {
+        bool ok = deq(lq) == -1;
+        for (int i = 0; i < 100; i++) {
+            enq(lq, i);
+        }
+        ok = ok && countQueue(lq) == 100;
+        for (int i = 0; i < 100; i++) {
+            ok = ok && deq(lq) == i;
+        }
+        ok = ok && deq(lq) == -1;
+
+        const int lock_threads = 4;
+        const int lock_items = 20000;
+        std::atomic<long long> sum(0);
+        std::atomic<int> taken(0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < lock_threads; t++) {
+            threads.emplace_back([lq, &sum, &taken, t, lock_items]() {
+                for (int i = 0; i < lock_items; i++) {
+                    enq(lq, t * lock_items + i);
+                    int value = deq(lq);
+                    if (value != -1) {
+                        sum += value;
+                        taken++;
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (int value = deq(lq); value != -1; value = deq(lq)) {
+            sum += value;
+            taken++;
+        }
+        long long n = static_cast<long long>(lock_threads) * lock_items;
+        return ok && taken.load() == n && sum.load() == n * (n - 1) / 2;
+    };
+
+    TwoLockQueue<int>* two_lock = createTwoLockQueue<int>();
+    bool two_lock_ok = check_queue(two_lock);
+    enq(two_lock, 7);
+    deleteTwoLockQueue(two_lock);
+    MutexQueue<int>* mutex_queue = createMutexQueue<int>();
+    bool mutex_ok = check_queue(mutex_queue);
+    deleteMutexQueue(mutex_queue);
+
+    if (!two_lock_ok || !mutex_ok) {
+        std::cerr << "FAIL: Lock-based baseline lost or reordered values (two-lock "
+                  << (two_lock_ok ? "ok" : "bad") << ", mutex " << (mutex_ok ? "ok" : "bad") << ")\n";
+    } else {
+        std::cout << "PASS: Two-lock and mutex+deque queues kept FIFO order and delivered every concurrent value once\n";
+    }
+}
+
+void run_correctness_test() {
+    std::cout << "\n=== Running Correctness Tests ===\n";
+    
+    test_single_threaded();
+    test_multi_threaded();
+    test_producer_consumer();
+    test_reclamation();
+    test_bulk_operations();
+    test_typed_payloads();
+    test_faa_queue();
+    test_bounded_ring();
+    test_role_queues();
+    test_blocking_dequeue();
+    test_coroutine_consumers();
+    test_backoff();
+    test_flat_combining();
+    test_size_estimate();
+    test_multi_queue();
+    test_ws_deque();
+    test_thread_pool();
+    test_bench_harness();
+    test_latency_histogram();
+    test_lock_queues();
+    
+    std::cout << "Correctness tests completed\n";
+}
+
+// Enqueue values for a benchmark: the binary file when present, otherwise none,
+// and buildSchedules draws its own.
+std::vector<uint32_t> load_benchmark_values(const BenchConfig& config) {
+    size_t expected_enqueues = benchThreadCount(config) * config.ops_per_thread;
+    if (!hasRoles(config)) {
+        expected_enqueues = expected_enqueues * config.enq_probability / 100;
+    }
+    
+    std::string file_path = "bin/random_values_insert.bin";
+    if (std::filesystem::exists(file_path)) {
+        return read_binary_data(file_path, expected_enqueues);
+    }
+    std::cout << "Warning: Binary file not found. Using generated values instead.\n";
+    return std::vector<uint32_t>();
+}
+
+void print_benchmark_config(const BenchConfig& config) {
+    if (hasRoles(config)) {
+        std::cout << "Producers: " << config.producers << ", Consumers: " << config.consumers;
+    } else {
+        std::cout << "Threads: " << config.threads;
+    }
+    std::cout << ", Operations per thread: " << config.ops_per_thread;
+    if (!hasRoles(config)) {
+        std::cout << ", Enqueue probability: " << config.enq_probability << "%";
+    }
+    if (config.duration.count() > 0) {
+        std::cout << ", Duration: " << config.duration.count() << " ms (schedules repeat)";
+    }
+    std::cout << "\n";
+}
+
+// Works on any queue with the MSQueue<int> API: enq, deq and countQueue.
+template <typename Queue>
+void run_performance_test(Queue* q, const char* queue_name, const BenchConfig& config) {
+    std::cout << "\n=== Running Performance Test (" << queue_name << ") ===\n";
+    print_benchmark_config(config);
+    
+    std::vector<std::vector<int32_t>> schedules = buildSchedules(config, load_benchmark_values(config));
+    BenchResult result = runBenchmark(config, schedules,
+        [q](int32_t value) { enq(q, static_cast<int>(value)); },
+        [q]() { return deq(q) != -1; });
+    
+    std::cout << "Performance Results:\n";
+    std::cout << "Total time: " << result.elapsed_ms << " ms\n";
+    std::cout << "Throughput: " << std::fixed << std::setprecision(2) << result.throughput() 
+              << " operations/second\n";
+    std::cout << "Enqueues performed: " << result.enqueues << "\n";
+    std::cout << "Successful dequeues: " << result.dequeues << "\n";
+    std::cout << "Empty dequeues: " << result.empty_dequeues << "\n";
+    std::cout << "Final queue size: " << countQueue(q) << "\n";
+}
+
+void run_scalability_test(size_t op_count = 1000000, int enq_probability = 50) {
+    std::cout << "\n=== Running Scalability Test ===\n";
+    std::cout << "Operations per thread: " << op_count 
+              << ", Enqueue probability: " << enq_probability << "%\n";
+    
+    std::vector<size_t> thread_counts = {1, 2, 4, 8, 16};
+    
+    // Loaded once, sized for the widest run; buildSchedules reuses it round-robin.
+    BenchConfig widest;
+    widest.threads = thread_counts.back();
+    widest.ops_per_thread = op_count;
+    widest.enq_probability = enq_probability;
+    std::vector<uint32_t> enq_values = load_benchmark_values(widest);
+    
+    std::cout << "-----------------------------------------------------------------------------------------------------\n";
+    std::cout << "| Threads |   Time (ms)  | Throughput (ops/s) | Empty deq | Speedup | new/delete (ops/s) | Pool gain |\n";
+    std::cout << "-----------------------------------------------------------------------------------------------------\n";
+    
+    const BackoffPolicy policies[] = {BackoffPolicy::None, BackoffPolicy::Pause,
+                                      BackoffPolicy::Exponential, BackoffPolicy::Randomized};
+    std::ostringstream backoff_rows;
+    double base_throughput = 0;
+    
+    for (size_t thread_count : thread_counts) {
+        BenchConfig bench;
+        bench.threads = thread_count;
+        bench.ops_per_thread = op_count;
+        bench.enq_probability = enq_probability;
+        std::vector<std::vector<int32_t>> schedules = buildSchedules(bench, enq_values);
+        
+        auto run_once = [&](const MSQueueConfig& config, ContentionStats& stats) {
+            MSQueue<int>* q = createMSQueue(config);
+            BenchResult result = runBenchmark(bench, schedules,
+                [q](int32_t value) { enq(q, static_cast<int>(value)); },
+                [q]() { return deq(q) != -1; });
+            stats = contentionStats(q);
+            deleteMSQueue(q);
+            return result;
+        };
+        
+        MSQueueConfig unpooled;
+        unpooled.use_pool = false;
+        ContentionStats stats;
+        double unpooled_throughput = run_once(unpooled, stats).throughput();
+        BenchResult pooled = run_once(MSQueueConfig(), stats);
+        double throughput = pooled.throughput();
+        
+        backoff_rows << "| " << std::setw(7) << thread_count << " |";
+        for (BackoffPolicy policy : policies) {
+            MSQueueConfig config;
+            config.backoff = policy;
+            ContentionStats policy_stats;
+            double policy_throughput = policy == BackoffPolicy::None
+                ? throughput : run_once(config, policy_stats).throughput();
+            if (policy == BackoffPolicy::None) {
+                policy_stats = stats;
+            }
+            backoff_rows << " " << std::setw(12) << std::fixed << std::setprecision(0) << policy_throughput
+                         << " " << std::setw(6) << std::fixed << std::setprecision(2)
+                         << policy_stats.failureRate() * 100 << "% |";
+        }
+        backoff_rows << "\n";
+        
+        double speedup = 1.0;
+        if (thread_count == 1) {
+            base_throughput = throughput;
+        } else {
+            speedup = throughput / base_throughput;
+        }
+        
+        std::cout << "| " << std::setw(7) << thread_count 
+                  << " | " << std::setw(12) << std::fixed << std::setprecision(2) << pooled.elapsed_ms 
+                  << " | " << std::setw(18) << std::fixed << std::setprecision(2) << throughput 
+                  << " | " << std::setw(8) << std::fixed << std::setprecision(2) << pooled.emptyFraction() * 100 << "%"
+                  << " | " << std::setw(7) << std::fixed << std::setprecision(2) << speedup 
+                  << " | " << std::setw(18) << std::fixed << std::setprecision(2) << unpooled_throughput 
+                  << " | " << std::setw(8) << std::fixed << std::setprecision(2) << throughput / unpooled_throughput 
+                  << "x |\n";
+    }
+    
+    std::cout << "-----------------------------------------------------------------------------------------------------\n";
+    
+    std::cout << "\nBackoff policies (throughput ops/s, CAS failure rate on tail->next and head):\n";
+    std::cout << "---------------------------------------------------------------------------------------------\n";
+    std::cout << "| Threads |";
+    for (BackoffPolicy policy : policies) {
+        std::cout << " " << std::setw(20) << backoffName(policy) << " |";
+    }
+    std::cout << "\n";
+    std::cout << "---------------------------------------------------------------------------------------------\n";
+    std::cout << backoff_rows.str();
+    std::cout << "---------------------------------------------------------------------------------------------\n";
+}
+
+// Thread counts for the comparison sweep: powers of two up to config.threads,
+// plus config.threads itself. With roles there is a single point.
+std::vector<BenchConfig> comparison_sweep(const BenchConfig& config) {
+    std::vector<BenchConfig> sweep;
+    if (hasRoles(config)) {
+        sweep.push_back(config);
+        return sweep;
+    }
+    for (size_t threads = 1; threads < config.threads; threads *= 2) {
+        BenchConfig point = config;
+        point.threads = threads;
+        sweep.push_back(point);
+    }
+    sweep.push_back(config);
+    return sweep;
+}
+
+// Runs the selected queue, Boost's lock-free queue and the two lock-based
+// baselines (lock_queue.h) on the same schedules at every thread count.
+template <typename Queue>
+void compare_with_boost(Queue* ms_queue, const char* queue_name, const BenchConfig& config) {
+    std::cout << "\n=== Comparing " << queue_name << " with Boost and Lock-Based Queues ===\n";
+    print_benchmark_config(config);
+    std::vector<BenchConfig> sweep = comparison_sweep(config);
+    std::vector<uint32_t> values = load_benchmark_values(config);
+    if (sweep.size() > 1) {
+        std::cout << "Thread sweep: 1.." << config.threads << ", throughput in ops/s\n";
+    }
+    
+    std::cout << "\nComparison Results:\n";
+    std::cout << "---------------------------------------------------------------------------------------------------------------\n";
+    std::cout << "| Threads | " << std::setw(14) << queue_name << " |    Boost Queue |  Two-Lock (MS) |  Mutex + Deque | vs best lock | Empty deq |\n";
+    std::cout << "---------------------------------------------------------------------------------------------------------------\n";
+    
+    for (const BenchConfig& point : sweep) {
+        // Every queue replays the same schedules.
+        std::vector<std::vector<int32_t>> schedules = buildSchedules(point, values);
+        
+        while (deq(ms_queue) != -1) {}
+        BenchResult ms_result = runBenchmark(point, schedules,
+            [ms_queue](int32_t value) { enq(ms_queue, static_cast<int>(value)); },
+            [ms_queue]() { return deq(ms_queue) != -1; });
+        
+        boost::lockfree::queue<int> boost_queue(1000);
+        BenchResult boost_result = runBenchmark(point, schedules,
+            [&boost_queue](int32_t value) { boost_queue.push(value); },
+            [&boost_queue]() { int value; return boost_queue.pop(value); });
+        
+        TwoLockQueue<int>* two_lock = createTwoLockQueue<int>();
+        BenchResult two_lock_result = runBenchmark(point, schedules,
+            [two_lock](int32_t value) { enq(two_lock, static_cast<int>(value)); },
+            [two_lock]() { return deq(two_lock) != -1; });
+        deleteTwoLockQueue(two_lock);
+        
+        MutexQueue<int>* mutex_queue = createMutexQueue<int>();
+        BenchResult mutex_result = runBenchmark(point, schedules,
+            [mutex_queue](int32_t value) { enq(mutex_queue, static_cast<int>(value)); },
+            [mutex_queue]() { return deq(mutex_queue) != -1; });
+        deleteMutexQueue(mutex_queue);
+        
+        double best_lock = std::max(two_lock_result.throughput(), mutex_result.throughput());
+        std::cout << "| " << std::setw(7) << benchThreadCount(point);
+        for (const BenchResult* r : {&ms_result, &boost_result, &two_lock_result, &mutex_result}) {
+            std::cout << " | " << std::setw(14) << std::fixed << std::setprecision(0) << r->throughput();
+        }
+        std::cout << " | " << std::setw(11) << std::fixed << std::setprecision(2) 
+                  << ms_result.throughput() / best_lock << "x |"
+                  << " " << std::setw(8) << std::fixed << std::setprecision(2) << ms_result.emptyFraction() * 100 << "% |\n";
+    }
+    std::cout << "---------------------------------------------------------------------------------------------------------------\n";
+}
+
+// Calls fn(q, name) with a fresh int queue of the kind picked by --queue.
+template <typename Fn>
+void with_selected_queue(const std::string& queue_kind, Fn fn) {
+    if (queue_kind == "fc") {
+        FCQueue<int>* q = createFCQueue<int>();
+        fn(q, "FC Queue");
+        deleteFCQueue(q);
+    } else if (queue_kind == "multi") {
+        MultiQueue<int>* q = createMultiQueue<int>();
+        fn(q, "MultiQueue");
+        deleteMultiQueue(q);
+    } else {
+        MSQueue<int>* q = createMSQueue();
+        fn(q, "MS Queue");
+        deleteMSQueue(q);
+    }
+}
+
+// Runs the usual random enqueue/dequeue mix against any queue through the two
+// callbacks and returns operations per second. deq_fn returns whether it got a
+// value; the schedules depend only on the seed, so every queue sees the same mix.
+template <typename EnqFn, typename DeqFn>
+double measure_mixed_throughput(size_t thread_count, size_t op_count, int enq_probability,
+                                EnqFn enq_fn, DeqFn deq_fn) {
+    BenchConfig config;
+    config.threads = thread_count;
+    config.ops_per_thread = op_count;
+    config.enq_probability = enq_probability;
+    std::vector<std::vector<int32_t>> schedules = buildSchedules(config, std::vector<uint32_t>());
+    return runBenchmark(config, schedules, enq_fn, deq_fn).throughput();
+}
+
+struct FifoDeviation {
+    double mean;
+    int64_t max;
+};
+
+// Tags every enqueue with a global ticket and every successful dequeue with
+// another; in a strict FIFO the k-th value out is the k-th value in, so
+// |enqueue ticket - dequeue ticket| is how far each value was reordered.
+template <typename EnqFn, typename DeqFn>
+FifoDeviation measure_fifo_deviation(size_t thread_count, size_t op_count, int enq_probability,
+                                     EnqFn enq_fn, DeqFn deq_fn) {
+    std::atomic<int64_t> enq_ticket(0);
+    std::atomic<int64_t> deq_ticket(0);
+    std::atomic<int64_t> total_error(0);
+    std::atomic<int64_t> max_error(0);
+    
+    auto worker = [&](int thread_id) {
+        std::mt19937 gen(thread_id + 1);
+        std::uniform_int_distribution<> op_dis(0, 99);
+        int64_t local_total = 0;
+        int64_t local_max = 0;
+        
+        for (size_t i = 0; i < op_count; i++) {
+            if (op_dis(gen) < enq_probability) {
+                enq_fn(enq_ticket.fetch_add(1));
+            } else {
+                int64_t value;
+                if (deq_fn(value)) {
+                    int64_t error = std::abs(value - deq_ticket.fetch_add(1));
+                    local_total += error;
+                    local_max = std::max(local_max, error);
+                }
+            }
+        }
+        total_error += local_total;
+        int64_t seen = max_error.load();
+        while (local_max > seen && !max_error.compare_exchange_weak(seen, local_max)) {
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_count; i++) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    int64_t dequeued = deq_ticket.load();
+    return {dequeued ? static_cast<double>(total_error.load()) / dequeued : 0.0, max_error.load()};
+}
+
+void run_faa_comparison(size_t op_count, int enq_probability = 50) {
+    std::cout << "\n=== Comparing FAA Segmented Queue with MS Queue and Boost ===\n";
+    std::cout << "Operations per thread: " << op_count 
+              << ", Enqueue probability: " << enq_probability << "%\n";
+    
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> thread_counts;
+    for (size_t t = 1; t < cores; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(cores);
+    
+    std::cout << "-----------------------------------------------------------------------------------\n";
+    std::cout << "| Threads |  MSQueue (ops/s)  | FAA queue (ops/s) |   Boost (ops/s)   | FAA vs MS |\n";
+    std::cout << "-----------------------------------------------------------------------------------\n";
+    
+    for (size_t thread_count : thread_counts) {
+        MSQueue<int>* ms_queue = createMSQueue();
+        double ms_throughput = measure_mixed_throughput(thread_count, op_count, enq_probability,
+            [&](int v) { enq(ms_queue, v); },
+            [&]() { return deq(ms_queue) != -1; });
+        deleteMSQueue(ms_queue);
+        
+        FAAQueue* faa_queue = createFAAQueue();
+        double faa_throughput = measure_mixed_throughput(thread_count, op_count, enq_probability,
+            [&](int v) { enq(faa_queue, v); },
+            [&]() { return deq(faa_queue) != -1; });
+        deleteFAAQueue(faa_queue);
+        
+        boost::lockfree::queue<int> boost_queue(1000);
+        double boost_throughput = measure_mixed_throughput(thread_count, op_count, enq_probability,
+            [&](int v) { boost_queue.push(v); },
+            [&]() { int v; return boost_queue.pop(v); });
+        
+        std::cout << "| " << std::setw(7) << thread_count 
+                  << " | " << std::setw(17) << std::fixed << std::setprecision(2) << ms_throughput 
+                  << " | " << std::setw(17) << std::fixed << std::setprecision(2) << faa_throughput 
+                  << " | " << std::setw(17) << std::fixed << std::setprecision(2) << boost_throughput 
+                  << " | " << std::setw(8) << std::fixed << std::setprecision(2) << faa_throughput / ms_throughput 
+                  << "x |\n";
+    }
+    
+    std::cout << "-----------------------------------------------------------------------------------\n";
+}
+
+void run_multiqueue_comparison(size_t op_count, int enq_probability = 50) {
+    std::cout << "\n=== Comparing Relaxed-FIFO MultiQueue with MS Queue ===\n";
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Operations per thread: " << op_count 
+              << ", Enqueue probability: " << enq_probability << "%, Lanes: " << 2 * cores << "\n";
+    
+    // At least four threads, so reordering shows up even on a small machine.
+    size_t max_threads = std::max<size_t>(cores, 4);
+    std::vector<size_t> thread_counts;
+    for (size_t t = 1; t < max_threads; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(max_threads);
+    
+    std::cout << "Rank error = |position dequeued - position enqueued|, mean / max over all dequeues\n";
+    std::cout << "--------------------------------------------------------------------------------------------------\n";
+    std::cout << "| Threads |  MSQueue (ops/s)  | MultiQueue (ops/s) | MQ vs MS |   MS rank error   |   MQ rank error   |\n";
+    std::cout << "--------------------------------------------------------------------------------------------------\n";
+    
+    for (size_t thread_count : thread_counts) {
+        MSQueue<int>* ms_queue = createMSQueue();
+        double ms_throughput = measure_mixed_throughput(thread_count, op_count, enq_probability,
+            [&](int v) { enq(ms_queue, v); },
+            [&]() { return deq(ms_queue) != -1; });
+        deleteMSQueue(ms_queue);
+        
+        MultiQueue<int>* multi_queue = createMultiQueue<int>();
+        double mq_throughput = measure_mixed_throughput(thread_count, op_count, enq_probability,
+            [&](int v) { enq(multi_queue, v); },
+            [&]() { return deq(multi_queue) != -1; });
+        deleteMultiQueue(multi_queue);
+        
+        // Separate runs: the shared tickets would otherwise dominate the timing.
+        MSQueue<int64_t>* ms_ordered = createMSQueue<int64_t>();
+        FifoDeviation ms_deviation = measure_fifo_deviation(thread_count, op_count, enq_probability,
+            [&](int64_t v) { enq(ms_ordered, v); },
+            [&](int64_t& v) { return try_dequeue(ms_ordered, v); });
+        deleteMSQueue(ms_ordered);
+        
+        MultiQueue<int64_t>* mq_ordered = createMultiQueue<int64_t>();
+        FifoDeviation mq_deviation = measure_fifo_deviation(thread_count, op_count, enq_probability,
+            [&](int64_t v) { enq(mq_ordered, v); },
+            [&](int64_t& v) { return try_dequeue(mq_ordered, v); });
+        deleteMultiQueue(mq_ordered);
+        
+        std::cout << "| " << std::setw(7) << thread_count 
+                  << " | " << std::setw(17) << std::fixed << std::setprecision(2) << ms_throughput 
+                  << " | " << std::setw(18) << std::fixed << std::setprecision(2) << mq_throughput 
+                  << " | " << std::setw(7) << std::fixed << std::setprecision(2) << mq_throughput / ms_throughput 
+                  << "x | " << std::setw(8) << std::fixed << std::setprecision(2) << ms_deviation.mean 
+                  << " / " << std::setw(6) << ms_deviation.max 
+                  << " | " << std::setw(8) << std::fixed << std::setprecision(2) << mq_deviation.mean 
+                  << " / " << std::setw(6) << mq_deviation.max << " |\n";
+    }
+    
+    std::cout << "--------------------------------------------------------------------------------------------------\n";
+}
+
+// Parallel fib in continuation-passing style: a task above the cutoff spawns
+// its two children and returns; the last child to finish completes the parent,
+// so no worker ever blocks on a join.
+struct FibTask {
+    int n;
+    FibTask* parent;
+    std::atomic<int> pending;
+    std::atomic<long long> sum;
+};
+
+long long serial_fib(int n) {
+    return n < 2 ? n : serial_fib(n - 1) + serial_fib(n - 2);
+}
+
+// push(worker, task) and take(worker, task&) decide where spawned tasks go and
+// where idle workers look; returns elapsed ms and stores fib(n) in result.
+template <typename PushFn, typename TakeFn>
+double run_fork_join_fib(size_t workers, int n, int cutoff, PushFn push, TakeFn take,
+                         long long& result, size_t& task_count) {
+    std::atomic<bool> done(false);
+    std::atomic<size_t> tasks(0);
+    
+    auto complete = [&](FibTask* task, long long value) {
+        while (true) {
+            FibTask* parent = task->parent;
+            delete task;
+            if (parent == nullptr) {
+                result = value;
+                done.store(true, std::memory_order_release);
+                return;
+            }
+            parent->sum.fetch_add(value, std::memory_order_relaxed);
+            if (parent->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
+            }
+            task = parent;
+            value = parent->sum.load(std::memory_order_relaxed);
+        }
+    };
+    
+    auto worker = [&](int id) {
+        size_t local_tasks = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            FibTask* task;
+            if (!take(id, task)) {
+                std::this_thread::yield();
+                continue;
+            }
+            local_tasks++;
+            if (task->n < cutoff) {
+                complete(task, serial_fib(task->n));
+            } else {
+                task->pending.store(2, std::memory_order_relaxed);
+                task->sum.store(0, std::memory_order_relaxed);
+                push(id, new FibTask{task->n - 2, task, {0}, {0}});
+                push(id, new FibTask{task->n - 1, task, {0}, {0}});
+            }
+        }
+        tasks += local_tasks;
+    };
+    
+    auto start_time = HR::now();
+    push(0, new FibTask{n, nullptr, {0}, {0}});
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; i++) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(HR::now() - start_time);
+    task_count = tasks.load();
+    return elapsed.count() / 1000.0;
+}
+
+void run_fork_join_comparison() {
+    const int n = 34;
+    const int cutoff = 12;
+    std::cout << "\n=== Fork-Join Benchmark: Work-Stealing Deques vs Shared MS Queue ===\n";
+    std::cout << "Parallel fib(" << n << "), tasks below n = " << cutoff << " run serially\n";
+    
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t max_threads = std::max<size_t>(cores, 4);
+    std::vector<size_t> thread_counts;
+    for (size_t t = 1; t < max_threads; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(max_threads);
+    
+    std::cout << "--------------------------------------------------------------------------------------\n";
+    std::cout << "| Workers |    Tasks    | MS queue (ms) | WS deques (ms) | WS tasks/s      | WS vs MS |\n";
+    std::cout << "--------------------------------------------------------------------------------------\n";
+    
+    long long expected = serial_fib(n);
+    for (size_t workers : thread_counts) {
+        long long ms_result = 0;
+        size_t ms_tasks = 0;
+        MSQueue<FibTask*>* shared = createMSQueue<FibTask*>();
+        double ms_elapsed = run_fork_join_fib(workers, n, cutoff,
+            [&](int, FibTask* task) { enq(shared, task); },
+            [&](int, FibTask*& task) { return try_dequeue(shared, task); },
+            ms_result, ms_tasks);
+        deleteMSQueue(shared);
+        
+        // The root is pushed from the main thread onto worker 0's deque before any
+        // worker starts, so the owner-only rule still holds.
+        long long ws_result = 0;
+        size_t ws_tasks = 0;
+        std::vector<WSDeque<FibTask*>*> deques;
+        for (size_t i = 0; i < workers; i++) {
+            deques.push_back(createWSDeque<FibTask*>());
+        }
+        double ws_elapsed = run_fork_join_fib(workers, n, cutoff,
+            [&](int id, FibTask* task) { wsPush(deques[id], task); },
+            [&](int id, FibTask*& task) {
+                if (wsPop(deques[id], task)) {
+                    return true;
+                }
+                static thread_local uint32_t victim_seed = 0x9E3779B9u;
+                for (size_t attempt = 0; attempt < workers; attempt++) {
+                    victim_seed = victim_seed * 1664525u + 1013904223u;
+                    size_t victim = (victim_seed >> 8) % workers;
+                    if (victim != static_cast<size_t>(id) && wsSteal(deques[victim], task)) {
+                        return true;
+                    }
+                }
+                return false;
+            },
+            ws_result, ws_tasks);
+        for (WSDeque<FibTask*>* d : deques) {
+            deleteWSDeque(d);
+        }
+        
+        if (ms_result != expected || ws_result != expected) {
+            std::cerr << "FAIL: fork-join fib returned " << ms_result << " / " << ws_result
+                      << " instead of " << expected << "\n";
+        }
+        
+        std::cout << "| " << std::setw(7) << workers 
+                  << " | " << std::setw(11) << ws_tasks 
+                  << " | " << std::setw(13) << std::fixed << std::setprecision(2) << ms_elapsed 
+                  << " | " << std::setw(14) << std::fixed << std::setprecision(2) << ws_elapsed 
+                  << " | " << std::setw(15) << std::fixed << std::setprecision(0) << ws_tasks / (ws_elapsed / 1000.0) 
+                  << " | " << std::setw(7) << std::fixed << std::setprecision(2) << ms_elapsed / ws_elapsed 
+                  << "x |\n";
+    }
+    
+    std::cout << "--------------------------------------------------------------------------------------\n";
+}
+
+void run_executor_benchmark(size_t thread_count) {
+    std::cout << "\n=== Thread-Pool Executor Overhead ===\n";
+    const size_t task_count = 200000;
+    const size_t range = 1 << 20;
+    const size_t grains[] = {1, 16, 256, 4096};
+    std::cout << "Workers: " << thread_count << ", empty tasks: " << task_count 
+              << ", parallel_for range: " << range << "\n";
+    
+    // Baseline the drivers use today: start and join raw threads for every run.
+    auto spawn_start = HR::now();
+    const int spawn_runs = 20;
+    for (int run = 0; run < spawn_runs; run++) {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < thread_count; i++) {
+            threads.emplace_back([]() {});
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    double spawn_us = std::chrono::duration_cast<std::chrono::nanoseconds>(HR::now() - spawn_start).count() 
+                      / 1000.0 / spawn_runs;
+    std::cout << "Spawning and joining " << thread_count << " std::threads: " << std::fixed 
+              << std::setprecision(1) << spawn_us << " us per run\n";
+    
+    std::vector<uint32_t> data(range);
+    auto serial_start = HR::now();
+    for (size_t i = 0; i < range; i++) {
+        data[i] = static_cast<uint32_t>(i * 2654435761u);
+    }
+    double serial_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(HR::now() - serial_start).count();
+    
+    std::cout << "----------------------------------------------------------------------------------------\n";
+    std::cout << "| Idle  | submit+run (ns/task) |     parallel_for per-task overhead (ns) by grain      |\n";
+    std::cout << "|       |                      |";
+    for (size_t grain : grains) {
+        std::cout << " " << std::setw(10) << grain << " |";
+    }
+    std::cout << "\n";
+    std::cout << "----------------------------------------------------------------------------------------\n";
+    
+    for (IdlePolicy idle : {IdlePolicy::Spin, IdlePolicy::Park}) {
+        ThreadPoolConfig config;
+        config.workers = thread_count;
+        config.idle = idle;
+        ThreadPool* pool = createThreadPool(config);
+        
+        WaitGroup wg;
+        std::atomic<size_t> ran(0);
+        auto submit_start = HR::now();
+        for (size_t i = 0; i < task_count; i++) {
+            wait_group_add(&wg, 1);
+            submit(pool, [&wg, &ran]() {
+                ran.fetch_add(1, std::memory_order_relaxed);
+                wait_group_done(&wg);
+            });
+        }
+        wait_group_wait(pool, &wg);
+        double submit_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(HR::now() - submit_start).count() 
+                           / static_cast<double>(task_count);
+        
+        std::cout << "| " << std::setw(5) << (idle == IdlePolicy::Spin ? "spin" : "park") 
+                  << " | " << std::setw(20) << std::fixed << std::setprecision(1) << submit_ns << " |";
+        for (size_t grain : grains) {
+            auto start = HR::now();
+            parallel_for(pool, 0, range, grain, [&data](size_t i) {
+                data[i] = static_cast<uint32_t>(i * 2654435761u);
+            });
+            double elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(HR::now() - start).count();
+            size_t chunks = (range + grain - 1) / grain;
+            // Time beyond the serial loop, spread over the tasks; it can go below
+            // zero when the workers really run in parallel.
+            std::cout << " " << std::setw(10) << std::fixed << std::setprecision(1) 
+                      << (elapsed_ns - serial_ns) / chunks << " |";
+        }
+        std::cout << "\n";
+        
+        deleteThreadPool(pool);
+        if (ran.load() != task_count) {
+            std::cerr << "FAIL: executor ran " << ran.load() << " of " << task_count << " tasks\n";
+        }
+    }
+    
+    std::cout << "----------------------------------------------------------------------------------------\n";
+}
+
+// Open-loop latency run: each producer enqueues a steady_clock timestamp on a
+// fixed schedule and each consumer records now minus that timestamp in its own
+// histogram. Paced producers stamp the time the element was due rather than
+// when it was sent, so a producer that falls behind still charges the delay to
+// the queue instead of hiding it. load_per_sec == 0 means enqueue flat out.
+struct LatencyRun {
+    double offered;
+    double achieved;
+    LatencyHistogram merged;
+    uint64_t worst_consumer_p99;
+};
+
+LatencyRun run_latency_once(size_t producers, size_t consumers, double load_per_sec,
+                            std::chrono::milliseconds duration) {
+    MSQueue<int64_t>* q = createMSQueue<int64_t>();
+    std::vector<LatencyHistogram> histograms(consumers);
+    std::atomic<size_t> producers_left(producers);
+    StartBarrier barrier;
+    
+    auto now_ns = []() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+    int64_t duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    double interval_ns = load_per_sec > 0 ? 1e9 * producers / load_per_sec : 0;
+    
+    auto producer = [&]() {
+        barrier.arriveAndWait();
+        int64_t start = now_ns();
+        for (uint64_t k = 0;; k++) {
+            int64_t now = now_ns();
+            if (now - start >= duration_ns) break;
+            int64_t stamp = now;
+            if (interval_ns > 0) {
+                stamp = start + static_cast<int64_t>(k * interval_ns);
+                for (uint32_t spins = 0; (now = now_ns()) < stamp; spins++) {
+                    if (spins % 64 == 63) {
+                        std::this_thread::yield();
+                    } else {
+                        cpuRelax();
+                    }
+                }
+            }
+            enq(q, stamp);
+        }
+        producers_left.fetch_sub(1, std::memory_order_release);
+    };
+    
+    auto consumer = [&](size_t index) {
+        LatencyHistogram local;
+        barrier.arriveAndWait();
+        int64_t stamp;
+        while (true) {
+            if (try_dequeue(q, stamp)) {
+                local.record(static_cast<uint64_t>(std::max<int64_t>(0, now_ns() - stamp)));
+            } else if (producers_left.load(std::memory_order_acquire) == 0) {
+                // Producers are finished, so one more miss means the queue is drained.
+                if (!try_dequeue(q, stamp)) break;
+                local.record(static_cast<uint64_t>(std::max<int64_t>(0, now_ns() - stamp)));
+            } else {
+                cpuRelax();
+            }
+        }
+        histograms[index] = std::move(local);
+    };
+    
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < producers; i++) {
+        threads.emplace_back(producer);
+    }
+    for (size_t i = 0; i < consumers; i++) {
+        threads.emplace_back(consumer, i);
+    }
+    barrier.waitForArrivals(producers + consumers);
+    auto start_time = HR::now();
+    barrier.release();
+    for (auto& t : threads) {
+        t.join();
+    }
+    double elapsed_s = std::chrono::duration<double>(HR::now() - start_time).count();
+    deleteMSQueue(q);
+    
+    LatencyRun run;
+    run.offered = load_per_sec;
+    run.worst_consumer_p99 = 0;
+    for (const LatencyHistogram& h : histograms) {
+        run.merged.merge(h);
+        run.worst_consumer_p99 = std::max(run.worst_consumer_p99, h.percentile(99));
+    }
+    run.achieved = run.merged.count() / elapsed_s;
+    return run;
+}
+
+void run_latency_test(std::chrono::milliseconds duration) {
+    if (duration.count() == 0) {
+        duration = std::chrono::milliseconds(200);
+    }
+    std::cout << "\n=== MS Queue Sojourn Latency (enqueue to dequeue) ===\n";
+    std::cout << "Each point runs for " << duration.count() << " ms; latencies in microseconds, "
+              << "\"worst C p99\" is the highest p99 seen by a single consumer\n";
+    
+    const std::pair<size_t, size_t> ratios[] = {{1, 1}, {2, 1}, {1, 2}, {3, 1}};
+    const double loads[] = {100000, 1000000, 0};
+    const double percentiles[] = {50, 90, 99, 99.9, 99.99};
+    
+    std::cout << "--------------------------------------------------------------------------------------------------------------\n";
+    std::cout << "| P:C |  Offered/s |  Achieved/s |      p50 |      p90 |      p99 |    p99.9 |   p99.99 |      max | worst C p99 |\n";
+    std::cout << "--------------------------------------------------------------------------------------------------------------\n";
+    
+    for (const auto& ratio : ratios) {
+        for (double load : loads) {
+            LatencyRun run = run_latency_once(ratio.first, ratio.second, load, duration);
+            std::ostringstream mix;
+            mix << ratio.first << ":" << ratio.second;
+            std::cout << "| " << std::setw(3) << mix.str() << " | ";
+            if (load > 0) {
+                std::cout << std::setw(10) << std::fixed << std::setprecision(0) << load;
+            } else {
+                std::cout << std::setw(10) << "max";
+            }
+            std::cout << " | " << std::setw(11) << std::fixed << std::setprecision(0) << run.achieved << " |";
+            for (double p : percentiles) {
+                std::cout << " " << std::setw(8) << std::fixed << std::setprecision(1) 
+                          << run.merged.percentile(p) / 1000.0 << " |";
+            }
+            std::cout << " " << std::setw(8) << std::fixed << std::setprecision(1) << run.merged.max() / 1000.0 
+                      << " | " << std::setw(11) << std::fixed << std::setprecision(1) 
+                      << run.worst_consumer_p99 / 1000.0 << " |\n";
+        }
+    }
+    
+    std::cout << "--------------------------------------------------------------------------------------------------------------\n";
+}
+
+void run_bounded_comparison(size_t thread_count, size_t op_count, int enq_probability = 50) {
+    std::cout << "\n=== Comparing Bounded Ring with MS Queue ===\n";
+    std::cout << "Threads: " << thread_count << ", Operations per thread: " << op_count 
+              << ", Enqueue probability: " << enq_probability << "%\n";
+    
+    const size_t capacity = 1 << 16;
+    
+    MSQueue<int>* ms_queue = createMSQueue();
+    double ms_throughput = measure_mixed_throughput(thread_count, op_count, enq_probability,
+        [&](int v) { enq(ms_queue, v); },
+        [&]() { return deq(ms_queue) != -1; });
+    deleteMSQueue(ms_queue);
+    
+    BoundedQueue<int>* ring = createBoundedQueue<int>(capacity);
+    std::atomic<size_t> rejected(0);
+    double ring_throughput = measure_mixed_throughput(thread_count, op_count, enq_probability,
+        [&](int v) {
+            if (!try_enqueue(ring, v)) rejected.fetch_add(1, std::memory_order_relaxed);
+        },
+        [&]() { int v; return try_dequeue(ring, v); });
+    deleteBoundedQueue(ring);
+    
+    // Batches of 32: each thread fills and then drains its own burst.
+    const size_t batch = 32;
+    size_t rounds = std::max<size_t>(1, op_count / (2 * batch));
+    auto run_batches = [&](auto enqueue_batch, auto dequeue_batch) {
+        auto worker = [&](int thread_id) {
+            std::vector<int> buffer(batch);
+            for (size_t r = 0; r < rounds; r++) {
+                for (size_t k = 0; k < batch; k++) {
+                    buffer[k] = thread_id * 1000 + k;
+                }
+                enqueue_batch(buffer.data(), batch);
+                size_t got = 0;
+                while (got < batch) {
+                    got += dequeue_batch(buffer.data(), batch - got);
+                }
+            }
+        };
+        
+        auto start_time = HR::now();
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < thread_count; i++) {
+            threads.emplace_back(worker, i);
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(HR::now() - start_time);
+        return 2.0 * thread_count * rounds * batch / (elapsed.count() / 1e6);
+    };
+    
+    ms_queue = createMSQueue();
+    double ms_batch_throughput = run_batches(
+        [&](const int* values, size_t n) { enq_bulk(ms_queue, values, n); },
+        [&](int* out, size_t n) { return deq_bulk(ms_queue, out, n); });
+    deleteMSQueue(ms_queue);
+    
+    ring = createBoundedQueue<int>(capacity);
+    double ring_batch_throughput = run_batches(
+        [&](const int* values, size_t n) {
+            size_t done = 0;
+            while (done < n) {
+                done += try_enqueue_bulk(ring, values + done, n - done);
+            }
+        },
+        [&](int* out, size_t n) { return try_dequeue_bulk(ring, out, n); });
+    deleteBoundedQueue(ring);
+    
+    std::cout << "--------------------------------------------------------------\n";
+    std::cout << "| Workload          | MSQueue (ops/s) | Ring (ops/s)    | Ratio |\n";
+    std::cout << "--------------------------------------------------------------\n";
+    std::cout << "| Mixed single ops  | " << std::setw(15) << std::fixed << std::setprecision(2) << ms_throughput 
+              << " | " << std::setw(15) << ring_throughput 
+              << " | " << std::setw(5) << ring_throughput / ms_throughput << " |\n";
+    std::cout << "| Batches of " << std::setw(3) << batch << "    | " << std::setw(15) << ms_batch_throughput 
+              << " | " << std::setw(15) << ring_batch_throughput 
+              << " | " << std::setw(5) << ring_batch_throughput / ms_batch_throughput << " |\n";
+    std::cout << "--------------------------------------------------------------\n";
+    std::cout << "Ring capacity: " << capacity << " slots (" << capacity * sizeof(BoundedQueue<int>::Cell) / 1024 
+              << " KiB, fixed), enqueues rejected while full: " << rejected.load() << "\n";
+}
+
+// Dedicated producer and consumer threads move producers * items values through
+// q; returns values delivered per second.
+template <typename Queue>
+double measure_role_throughput(Queue* q, size_t producers, size_t consumers, size_t items) {
+    const size_t total = producers * items;
+    std::atomic<size_t> consumed(0);
+    
+    auto producer = [&](int thread_id) {
+        for (size_t j = 0; j < items; j++) {
+            while (!try_enqueue(q, static_cast<int>(thread_id * items + j))) {
+                std::this_thread::yield();
+            }
+        }
+    };
+    
+    auto consumer = [&]() {
+        int value;
+        size_t local = 0;
+        while (consumed.load(std::memory_order_relaxed) < total) {
+            if (try_dequeue(q, value)) {
+                if (++local == 64) {
+                    consumed.fetch_add(local, std::memory_order_relaxed);
+                    local = 0;
+                }
+            } else {
+                consumed.fetch_add(local, std::memory_order_relaxed);
+                local = 0;
+                std::this_thread::yield();
+            }
+        }
+    };
+    
+    auto start_time = HR::now();
+    
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < producers; i++) {
+        threads.emplace_back(producer, i);
+    }
+    for (size_t i = 0; i < consumers; i++) {
+        threads.emplace_back(consumer);
+    }
+    
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(HR::now() - start_time);
+    return total / (elapsed.count() / 1e6);
+}
+
+void run_role_comparison(bool single_producer, size_t thread_count, size_t op_count) {
+    size_t producers = single_producer ? 1 : std::max<size_t>(1, thread_count - 1);
+    std::cout << "\n=== Running " << (single_producer ? "SPSC" : "MPSC") << " Role Benchmark ===\n";
+    std::cout << "Producers: " << producers << ", Consumers: 1, Values per producer: " << op_count << "\n";
+    
+    const size_t capacity = 1 << 16;
+    std::vector<std::pair<std::string, double>> rows;
+    
+    if (single_producer) {
+        auto* spsc = createRoleQueue<int, SingleProducer, SingleConsumer>(capacity);
+        rows.push_back({"SPSC ring", measure_role_throughput(spsc, producers, 1, op_count)});
+        deleteRoleQueue<int, SingleProducer, SingleConsumer>(spsc);
+    }
+    
+    auto* mpsc = createRoleQueue<int, MultiProducer, SingleConsumer>();
+    rows.push_back({"MPSC intrusive", measure_role_throughput(mpsc, producers, 1, op_count)});
+    deleteRoleQueue<int, MultiProducer, SingleConsumer>(mpsc);
+    
+    BoundedQueue<int>* ring = createBoundedQueue<int>(capacity);
+    rows.push_back({"MPMC bounded ring", measure_role_throughput(ring, producers, 1, op_count)});
+    deleteBoundedQueue(ring);
+    
+    MSQueue<int>* ms_queue = createMSQueue();
+    double ms_throughput = measure_role_throughput(ms_queue, producers, 1, op_count);
+    rows.push_back({"MSQueue (MPMC)", ms_throughput});
+    deleteMSQueue(ms_queue);
+    
+    std::cout << "--------------------------------------------------------\n";
+    std::cout << "| Queue              | Throughput (ops/s) | vs MSQueue |\n";
+    std::cout << "--------------------------------------------------------\n";
+    for (const auto& row : rows) {
+        std::cout << "| " << std::left << std::setw(18) << row.first << std::right 
+                  << " | " << std::setw(18) << std::fixed << std::setprecision(2) << row.second 
+                  << " | " << std::setw(9) << std::fixed << std::setprecision(2) << row.second / ms_throughput 
+                  << "x |\n";
+    }
+    std::cout << "--------------------------------------------------------\n";
+}
+
+static double process_cpu_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void run_blocking_test(size_t thread_count) {
+    std::cout << "\n=== Running Blocking Dequeue Test ===\n";
+    size_t consumers = std::max<size_t>(1, thread_count);
+    std::cout << "Idle consumers: " << consumers << "\n";
+    
+    // Idle cost: consumers wait on an empty queue for a fixed window.
+    auto idle_cpu = [&](bool park) {
+        MSQueue<int>* q = createMSQueue();
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> threads;
+        double cpu_start = process_cpu_seconds();
+        auto wall_start = HR::now();
+        for (size_t i = 0; i < consumers; i++) {
+            threads.emplace_back([&]() {
+                int item;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    if (park) {
+                        dequeue_wait(q, item);
+                    } else {
+                        try_dequeue(q, item);
+                    }
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        stop.store(true);
+        for (size_t i = 0; i < consumers; i++) {
+            enq(q, 0);
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        double wall = std::chrono::duration<double>(HR::now() - wall_start).count();
+        double cpu = process_cpu_seconds() - cpu_start;
+        deleteMSQueue(q);
+        return 100.0 * cpu / wall;
+    };
+    
+    // Wake latency: one consumer waits, the producer enqueues a timestamp after a
+    // pause long enough for the consumer to have parked.
+    auto wake_latency = [&](bool park, std::vector<double>& samples) {
+        MSQueue<int64_t>* q = createMSQueue<int64_t>();
+        const int rounds = 200;
+        std::thread consumer([&]() {
+            int64_t sent;
+            for (int r = 0; r < rounds; r++) {
+                if (park) {
+                    dequeue_wait(q, sent);
+                } else {
+                    while (!try_dequeue(q, sent)) {
+                    }
+                }
+                int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+                samples.push_back((now - sent) / 1000.0);
+            }
+        });
+        for (int r = 0; r < rounds; r++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            enq(q, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count()));
+        }
+        consumer.join();
+        deleteMSQueue(q);
+        std::sort(samples.begin(), samples.end());
+    };
+    
+    double spin_cpu = idle_cpu(false);
+    double park_cpu = idle_cpu(true);
+    std::vector<double> spin_samples, park_samples;
+    wake_latency(false, spin_samples);
+    wake_latency(true, park_samples);
+    
+    auto percentile = [](const std::vector<double>& v, double p) {
+        return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+    };
+    
+    std::cout << "-------------------------------------------------------------------\n";
+    std::cout << "| Consumer         | Idle CPU (%) | Wake p50 (us) | Wake p99 (us) |\n";
+    std::cout << "-------------------------------------------------------------------\n";
+    std::cout << "| try_dequeue spin | " << std::setw(12) << std::fixed << std::setprecision(1) << spin_cpu 
+              << " | " << std::setw(13) << std::setprecision(2) << percentile(spin_samples, 0.50) 
+              << " | " << std::setw(13) << percentile(spin_samples, 0.99) << " |\n";
+    std::cout << "| dequeue_wait     | " << std::setw(12) << std::fixed << std::setprecision(1) << park_cpu 
+              << " | " << std::setw(13) << std::setprecision(2) << percentile(park_samples, 0.50) 
+              << " | " << std::setw(13) << percentile(park_samples, 0.99) << " |\n";
+    std::cout << "-------------------------------------------------------------------\n";
+    std::cout << "Idle CPU is process CPU time over wall time (100% = one core).\n";
+}
+
+DetachedTask sum_one(MSQueue<int>* q, CoroExecutor* executor, std::atomic<long long>* sum,
+                     std::atomic<size_t>* done) {
+    int value = co_await dequeue_async(q, executor);
+    sum->fetch_add(value, std::memory_order_relaxed);
+    done->fetch_add(1, std::memory_order_relaxed);
+}
+
+void run_coroutine_test(size_t thread_count, size_t consumer_count = 1000000) {
+    std::cout << "\n=== Running Coroutine Consumer Test ===\n";
+    size_t producers = std::max<size_t>(1, thread_count);
+    std::cout << "Coroutine consumers: " << consumer_count << ", Producer threads: " << producers << "\n";
+    
+    MSQueue<int>* q = createMSQueue();
+    LoopExecutor executor;
+    std::atomic<long long> sum(0);
+    std::atomic<size_t> done(0);
+    
+    auto start_time = HR::now();
+    for (size_t i = 0; i < consumer_count; i++) {
+        sum_one(q, &executor, &sum, &done);
+    }
+    auto suspended_time = HR::now();
+    
+    // One thread drives the executor while the producers hand values over.
+    std::thread runner([&]() {
+        while (done.load(std::memory_order_relaxed) < consumer_count) {
+            if (executor.run_pending() == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    
+    std::vector<std::thread> threads;
+    size_t per_producer = consumer_count / producers;
+    for (size_t p = 0; p < producers; p++) {
+        size_t count = (p == producers - 1) ? consumer_count - per_producer * (producers - 1) : per_producer;
+        threads.emplace_back([&, count]() {
+            for (size_t i = 0; i < count; i++) {
+                enq(q, 1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    runner.join();
+    auto end_time = HR::now();
+    
+    double suspend_ms = std::chrono::duration<double, std::milli>(suspended_time - start_time).count();
+    double deliver_ms = std::chrono::duration<double, std::milli>(end_time - suspended_time).count();
+    
+    std::cout << "Suspend " << consumer_count << " coroutines: " << std::fixed << std::setprecision(2) 
+              << suspend_ms << " ms (" << suspend_ms * 1e6 / consumer_count << " ns each)\n";
+    std::cout << "Hand off and resume all: " << deliver_ms << " ms (" 
+              << consumer_count / (deliver_ms / 1000.0) << " values/s)\n";
+    std::cout << "Values left in queue: " << countQueue(q) << ", sum check: " 
+              << (sum.load() == static_cast<long long>(consumer_count) ? "PASSED" : "FAILED") << "\n";
+    
+    deleteMSQueue(q);
+}
+
+void run_burst_test(size_t thread_count, size_t op_count) {
+    std::cout << "\n=== Running Burst Test ===\n";
+    std::cout << "Threads: " << thread_count << ", Values per thread: " << op_count << "\n";
+    
+    std::vector<size_t> burst_sizes = {1, 8, 32, 128, 512};
+    
+    std::cout << "-----------------------------------------------------------------\n";
+    std::cout << "| Burst | Per-element (ops/s) |   Bulk (ops/s)   | Bulk speedup |\n";
+    std::cout << "-----------------------------------------------------------------\n";
+    
+    for (size_t burst : burst_sizes) {
+        // Each thread enqueues a burst and then drains a burst, so both sides
+        // see the same contention and only the per-call overhead differs.
+        auto run_once = [&](bool bulk) {
+            MSQueue<int>* q = createMSQueue();
+            size_t rounds = std::max<size_t>(1, op_count / burst);
+            
+            auto worker = [&](int thread_id) {
+                std::vector<int> buffer(burst);
+                for (size_t r = 0; r < rounds; r++) {
+                    for (size_t k = 0; k < burst; k++) {
+                        buffer[k] = thread_id * 1000 + k;
+                    }
+                    if (bulk) {
+                        enq_bulk(q, buffer.data(), burst);
+                        size_t drained = 0;
+                        while (drained < burst) {
+                            drained += deq_bulk(q, buffer.data(), burst - drained);
+                        }
+                    } else {
+                        for (size_t k = 0; k < burst; k++) {
+                            enq(q, buffer[k]);
+                        }
+                        size_t drained = 0;
+                        while (drained < burst) {
+                            if (deq(q) != -1) drained++;
+                        }
+                    }
+                }
+            };
+            
+            auto start_time = HR::now();
+            
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < thread_count; i++) {
+                threads.emplace_back(worker, i);
+            }
+            
+            for (auto& t : threads) {
+                t.join();
+            }
+            
+            auto end_time = HR::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+            double elapsed_ms = elapsed.count() / 1000.0;
+            
+            deleteMSQueue(q);
+            return 2.0 * thread_count * rounds * burst / (elapsed_ms / 1000.0);
+        };
+        
+        double single_throughput = run_once(false);
+        double bulk_throughput = run_once(true);
+        
+        std::cout << "| " << std::setw(5) << burst 
+                  << " | " << std::setw(19) << std::fixed << std::setprecision(2) << single_throughput 
+                  << " | " << std::setw(16) << std::fixed << std::setprecision(2) << bulk_throughput 
+                  << " | " << std::setw(12) << std::fixed << std::setprecision(2) << bulk_throughput / single_throughput 
+                  << " |\n";
+    }
+    
+    std::cout << "-----------------------------------------------------------------\n";
+}
+
+void run_workload_tests(const std::string& queue_kind) {
+    std::cout << "\n=== Running Workload Size Tests ===\n";
+    
+    std::vector<size_t> workload_sizes = {100000, 1000000, 10000000};
+    
+    for (size_t workload : workload_sizes) {
+        std::cout << "\nTesting workload size: " << workload << " operations\n";
+        
+        const size_t thread_count = 4;
+        size_t ops_per_thread = workload / thread_count;
+        
+        BenchConfig config;
+        config.threads = thread_count;
+        config.ops_per_thread = ops_per_thread;
+        with_selected_queue(queue_kind, [&](auto* q, const char* name) {
+            run_performance_test(q, name, config);
+        });
+    }
+}
+
+void show_usage() {
+    std::cout << "Usage: ./problem2 <test_type> [options]\n\n";
+    std::cout << "Test types:\n";
+    std::cout << "  correctness    - Run correctness tests\n";
+    std::cout << "  performance    - Run performance test (default)\n";
+    std::cout << "  scalability    - Run scalability test with varying thread counts\n";
+    std::cout << "  boost          - Compare with Boost's lock-free queue and the two-lock and mutex+deque baselines\n";
+    std::cout << "  workload       - Test with different workload sizes\n";
+    std::cout << "  burst          - Compare per-element and bulk operations across burst sizes\n";
+    std::cout << "  faa            - Compare the FAA segmented queue with MS Queue and Boost on 1..all cores\n";
+    std::cout << "  bounded        - Compare the bounded MPMC ring with MS Queue\n";
+    std::cout << "  multiqueue     - Relaxed-FIFO sharded MultiQueue vs MS Queue: throughput and FIFO deviation\n";
+    std::cout << "  forkjoin       - Parallel fib on per-worker work-stealing deques vs one shared MS Queue\n";
+    std::cout << "  executor       - Per-task overhead of the thread-pool executor, spinning vs parking idle workers\n";
+    std::cout << "  latency        - Enqueue-to-dequeue latency percentiles across producer:consumer ratios and loads\n";
+    std::cout << "  spsc           - One producer and one consumer: SPSC ring vs MPSC vs MPMC queues\n";
+    std::cout << "  mpsc           - threads-1 producers and one consumer: MPSC vs MPMC queues\n";
+    std::cout << "  blocking       - Idle CPU and wake-up latency of dequeue_wait vs spinning\n";
+    std::cout << "  coroutine      - A million coroutine consumers awaiting dequeue_async\n";
+    std::cout << "  all            - Run all tests\n\n";
+    
+    std::cout << "Options:\n";
+    std::cout << "  --threads <n>  - Set number of threads (default: 4)\n";
+    std::cout << "  --ops <n>      - Set operations per thread (default: 1000000)\n";
+    std::cout << "  --enq-prob <n> - Set enqueue probability percent (default: 50)\n";
+    std::cout << "  --queue <kind> - Queue for performance, boost and workload: ms, fc or multi (default: ms)\n";
+    std::cout << "  --producers <n> --consumers <n>\n";
+    std::cout << "                 - Performance and boost: dedicated enqueue-only and dequeue-only threads\n";
+    std::cout << "  --duration <ms> - Performance and boost: repeat the schedules for a fixed time;\n";
+    std::cout << "                  latency: time per measurement point (default: 200)\n";
 }
 
 int main(int argc, char* argv[]) {
@@ -481,6 +2593,10 @@ int main(int argc, char* argv[]) {
     size_t thread_count = 4;
     size_t op_count = 1000000;
     int enq_probability = 50;
+    std::string queue_kind = "ms";
+    size_t producers = 0;
+    size_t consumers = 0;
+    long duration_ms = 0;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -497,20 +2613,49 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: Enqueue probability must be between 0 and 100\n";
                 return 1;
             }
+        } else if (arg == "--producers" && i + 1 < argc) {
+            producers = std::stoi(argv[++i]);
+        } else if (arg == "--consumers" && i + 1 < argc) {
+            consumers = std::stoi(argv[++i]);
+        } else if (arg == "--duration" && i + 1 < argc) {
+            duration_ms = std::stol(argv[++i]);
+        } else if (arg == "--queue" && i + 1 < argc) {
+            queue_kind = argv[++i];
+            if (queue_kind != "ms" && queue_kind != "fc" && queue_kind != "multi") {
+                std::cerr << "Error: Queue must be ms, fc or multi\n";
+                return 1;
+            }
         } else if (arg == "--help" || arg == "-h") {
             show_usage();
             return 0;
         }
     }
     
+    if ((producers == 0) != (consumers == 0)) {
+        std::cerr << "Error: --producers and --consumers must be given together\n";
+        return 1;
+    }
+    
+    // Used by the performance and boost modes; latency only takes the duration.
+    BenchConfig bench_config;
+    bench_config.threads = thread_count;
+    bench_config.producers = producers;
+    bench_config.consumers = consumers;
+    bench_config.ops_per_thread = op_count;
+    bench_config.enq_probability = enq_probability;
+    bench_config.duration = std::chrono::milliseconds(duration_ms);
+    
     std::cout << "=== Lock-free Queue Implementation ===\n";
+    printLockFreeStatus();
     
     if (test_type == "correctness" || test_type == "all") {
         run_correctness_test();
     }
     
     if (test_type == "performance" || test_type == "all") {
-        run_performance_test(thread_count, op_count, enq_probability);
+        with_selected_queue(queue_kind, [&](auto* q, const char* name) {
+            run_performance_test(q, name, bench_config);
+        });
     }
     
     if (test_type == "scalability" || test_type == "all") {
@@ -518,11 +2663,57 @@ int main(int argc, char* argv[]) {
     }
     
     if (test_type == "boost" || test_type == "all") {
-        compare_with_boost(thread_count, op_count, enq_probability);
+        with_selected_queue(queue_kind, [&](auto* q, const char* name) {
+            compare_with_boost(q, name, bench_config);
+        });
     }
     
     if (test_type == "workload" || test_type == "all") {
-        run_workload_tests();
+        run_workload_tests(queue_kind);
+    }
+    
+    if (test_type == "burst" || test_type == "all") {
+        run_burst_test(thread_count, op_count);
+    }
+    
+    if (test_type == "faa" || test_type == "all") {
+        run_faa_comparison(op_count, enq_probability);
+    }
+    
+    if (test_type == "multiqueue" || test_type == "all") {
+        run_multiqueue_comparison(op_count, enq_probability);
+    }
+    
+    if (test_type == "forkjoin" || test_type == "all") {
+        run_fork_join_comparison();
+    }
+    
+    if (test_type == "executor" || test_type == "all") {
+        run_executor_benchmark(thread_count);
+    }
+    
+    if (test_type == "latency" || test_type == "all") {
+        run_latency_test(bench_config.duration);
+    }
+    
+    if (test_type == "bounded" || test_type == "all") {
+        run_bounded_comparison(thread_count, op_count, enq_probability);
+    }
+    
+    if (test_type == "spsc" || test_type == "all") {
+        run_role_comparison(true, thread_count, op_count);
+    }
+    
+    if (test_type == "mpsc" || test_type == "all") {
+        run_role_comparison(false, thread_count, op_count);
+    }
+    
+    if (test_type == "blocking" || test_type == "all") {
+        run_blocking_test(thread_count);
+    }
+    
+    if (test_type == "coroutine" || test_type == "all") {
+        run_coroutine_test(thread_count);
     }
     
     return 0;
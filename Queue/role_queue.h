@@ -0,0 +1,51 @@
+#ifndef ROLE_QUEUE_H
+#define ROLE_QUEUE_H
+
+#include "ms_queue.h"
+#include "mpsc_queue.h"
+#include "spsc_queue.h"
+
+// Producer and consumer policies. Picking the single-threaded side lets the
+// selector drop the CAS protocol that side would otherwise pay for.
+struct SingleProducer {};
+struct MultiProducer {};
+struct SingleConsumer {};
+struct MultiConsumer {};
+
+// Every selected queue supports try_enqueue(q, args...) and try_dequeue(q, out).
+// Only the SPSC ring is bounded; capacity is ignored by the others.
+template <typename T, typename Producers, typename Consumers>
+struct QueueSelector {
+    typedef MSQueue<T> type;
+    static type* create(size_t) { return createMSQueue<T>(); }
+    static void destroy(type* q) { deleteMSQueue(q); }
+};
+
+template <typename T>
+struct QueueSelector<T, SingleProducer, SingleConsumer> {
+    typedef SPSCQueue<T> type;
+    static type* create(size_t capacity) { return createSPSCQueue<T>(capacity); }
+    static void destroy(type* q) { deleteSPSCQueue(q); }
+};
+
+template <typename T>
+struct QueueSelector<T, MultiProducer, SingleConsumer> {
+    typedef MPSCQueue<T> type;
+    static type* create(size_t) { return createMPSCQueue<T>(); }
+    static void destroy(type* q) { deleteMPSCQueue(q); }
+};
+
+template <typename T, typename Producers, typename Consumers>
+using RoleQueue = typename QueueSelector<T, Producers, Consumers>::type;
+
+template <typename T, typename Producers, typename Consumers>
+RoleQueue<T, Producers, Consumers>* createRoleQueue(size_t capacity = 1 << 16) {
+    return QueueSelector<T, Producers, Consumers>::create(capacity);
+}
+
+template <typename T, typename Producers, typename Consumers>
+void deleteRoleQueue(RoleQueue<T, Producers, Consumers>* q) {
+    QueueSelector<T, Producers, Consumers>::destroy(q);
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Wait-free ring for exactly one producer and one consumer. Each side owns one
+// index and keeps a private copy of the other's, so it only touches the shared
+// cache line when its copy says the ring is full (or empty).
+template <typename T>
+struct SPSCQueue {
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* payload() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    Slot* slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> tail;
+    size_t cached_head;
+    alignas(64) std::atomic<size_t> head;
+    size_t cached_tail;
+};
+
+// Capacity is rounded up to a power of two.
+template <typename T>
+SPSCQueue<T>* createSPSCQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    SPSCQueue<T>* q = new SPSCQueue<T>();
+    q->slots = new typename SPSCQueue<T>::Slot[size];
+    q->mask = size - 1;
+    q->tail.store(0, std::memory_order_relaxed);
+    q->head.store(0, std::memory_order_relaxed);
+    q->cached_head = 0;
+    q->cached_tail = 0;
+    return q;
+}
+
+template <typename T>
+void deleteSPSCQueue(SPSCQueue<T>* q) {
+    size_t end = q->tail.load(std::memory_order_relaxed);
+    for (size_t pos = q->head.load(std::memory_order_relaxed); pos != end; ++pos) {
+        q->slots[pos & q->mask].payload()->~T();
+    }
+    delete[] q->slots;
+    delete q;
+}
+
+// Producer side only.
+template <typename T, typename... Args>
+bool try_enqueue(SPSCQueue<T>* q, Args&&... args) {
+    size_t tail = q->tail.load(std::memory_order_relaxed);
+    if (tail - q->cached_head > q->mask) {
+        q->cached_head = q->head.load(std::memory_order_acquire);
+        if (tail - q->cached_head > q->mask) {
+            return false;
+        }
+    }
+    new (q->slots[tail & q->mask].storage) T(std::forward<Args>(args)...);
+    q->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+// Consumer side only.
+template <typename T>
+bool try_dequeue(SPSCQueue<T>* q, T& out) {
+    size_t head = q->head.load(std::memory_order_relaxed);
+    if (head == q->cached_tail) {
+        q->cached_tail = q->tail.load(std::memory_order_acquire);
+        if (head == q->cached_tail) {
+            return false;
+        }
+    }
+    T* payload = q->slots[head & q->mask].payload();
+    out = std::move(*payload);
+    payload->~T();
+    q->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+#endif
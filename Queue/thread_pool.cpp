@@ -0,0 +1,151 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <climits>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Which pool, if any, the calling thread works for, and its queue there.
+static thread_local ThreadPool* current_pool = nullptr;
+static thread_local size_t current_index = 0;
+
+static bool takeTask(ThreadPool* pool, size_t home, PoolTask& task) {
+    size_t n = pool->queues.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (try_dequeue(pool->queues[(home + i) % n], task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool anyTaskQueued(ThreadPool* pool) {
+    for (MSQueue<PoolTask>* q : pool->queues) {
+        if (size_approx(q) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void wakeWorkers(ThreadPool* pool, int count) {
+    pool->wake_seq.fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&pool->wake_seq), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+// Pairs with the light fence in submit: either the submitter sees this worker
+// in sleepers, or this worker sees the task it queued.
+static void parkWorker(ThreadPool* pool) {
+    uint32_t seq = pool->wake_seq.load(std::memory_order_acquire);
+    pool->sleepers.fetch_add(1, std::memory_order_relaxed);
+    asymmetricHeavyFence();
+    if (!anyTaskQueued(pool) && !pool->stopping.load(std::memory_order_acquire)) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&pool->wake_seq), FUTEX_WAIT_PRIVATE, seq, nullptr, nullptr, 0);
+    }
+    pool->sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+static void pinToCpu(size_t cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void workerLoop(ThreadPool* pool, size_t index) {
+    current_pool = pool;
+    current_index = index;
+    PoolTask task;
+    uint32_t idle_rounds = 0;
+    while (true) {
+        if (takeTask(pool, index, task)) {
+            task();
+            idle_rounds = 0;
+            continue;
+        }
+        if (pool->stopping.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (pool->idle == IdlePolicy::Spin || idle_rounds < pool->spin_rounds) {
+            idle_rounds++;
+            cpuRelax();
+            continue;
+        }
+        parkWorker(pool);
+        idle_rounds = 0;
+    }
+    current_pool = nullptr;
+}
+
+ThreadPool* createThreadPool(const ThreadPoolConfig& config) {
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t workers = config.workers ? config.workers : cores;
+
+    ThreadPool* pool = new ThreadPool();
+    pool->idle = config.idle;
+    pool->spin_rounds = config.spin_rounds;
+    pool->stopping.store(false, std::memory_order_relaxed);
+    pool->next_queue.store(0, std::memory_order_relaxed);
+    pool->sleepers.store(0, std::memory_order_relaxed);
+    pool->wake_seq.store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < workers; ++i) {
+        pool->queues.push_back(createMSQueue<PoolTask>());
+    }
+    bool pin = config.pin;
+    for (size_t i = 0; i < workers; ++i) {
+        pool->threads.emplace_back([pool, i, cores, pin]() {
+            if (pin) {
+                pinToCpu(i % cores);
+            }
+            workerLoop(pool, i);
+        });
+    }
+    return pool;
+}
+
+void deleteThreadPool(ThreadPool* pool) {
+    pool->stopping.store(true, std::memory_order_release);
+    wakeWorkers(pool, INT_MAX);
+    for (std::thread& t : pool->threads) {
+        t.join();
+    }
+    for (MSQueue<PoolTask>* q : pool->queues) {
+        deleteMSQueue(q);
+    }
+    delete pool;
+}
+
+size_t workerCount(const ThreadPool* pool) {
+    return pool->queues.size();
+}
+
+void submit(ThreadPool* pool, PoolTask task) {
+    size_t index = current_pool == pool
+        ? current_index
+        : pool->next_queue.fetch_add(1, std::memory_order_relaxed) % pool->queues.size();
+    enq(pool->queues[index], std::move(task));
+    asymmetricLightFence();
+    if (pool->sleepers.load(std::memory_order_relaxed) != 0) {
+        wakeWorkers(pool, 1);
+    }
+}
+
+bool runPendingTask(ThreadPool* pool) {
+    size_t home = current_pool == pool ? current_index : 0;
+    PoolTask task;
+    if (!takeTask(pool, home, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void wait_group_wait(ThreadPool* pool, WaitGroup* wg) {
+    while (wg->pending.load(std::memory_order_acquire) != 0) {
+        if (!runPendingTask(pool)) {
+            std::this_thread::yield();
+        }
+    }
+}
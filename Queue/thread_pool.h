@@ -0,0 +1,91 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "ms_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+typedef std::function<void()> PoolTask;
+
+// What a worker does once every queue looked empty: keep spinning (lowest
+// wake-up latency, burns the core) or spin for spin_rounds and then sleep on a
+// futex until a submit wakes it.
+enum class IdlePolicy { Spin, Park };
+
+struct ThreadPoolConfig {
+    // 0 means one worker per hardware thread.
+    size_t workers = 0;
+    // Pin worker i to CPU i % cores.
+    bool pin = true;
+    IdlePolicy idle = IdlePolicy::Park;
+    uint32_t spin_rounds = 2048;
+};
+
+// Fixed set of workers, each with its own MSQueue of tasks. Submissions from a
+// worker go to its own queue, others are spread round-robin; a worker whose
+// queue is empty steals from the rest before it idles.
+struct ThreadPool {
+    std::vector<MSQueue<PoolTask>*> queues;
+    std::vector<std::thread> threads;
+    IdlePolicy idle;
+    uint32_t spin_rounds;
+    std::atomic<bool> stopping;
+    alignas(64) std::atomic<size_t> next_queue;
+    // Parked workers sleep on wake_seq; submit only makes a syscall while
+    // sleepers is non-zero.
+    alignas(64) std::atomic<uint32_t> sleepers;
+    std::atomic<uint32_t> wake_seq;
+};
+
+ThreadPool* createThreadPool(const ThreadPoolConfig& config = ThreadPoolConfig());
+// Runs every task already submitted, then joins the workers.
+void deleteThreadPool(ThreadPool* pool);
+size_t workerCount(const ThreadPool* pool);
+
+void submit(ThreadPool* pool, PoolTask task);
+// Runs one queued task on the calling thread; false if none was found.
+bool runPendingTask(ThreadPool* pool);
+
+// Counts outstanding tasks. wait_group_wait() runs pool tasks while it waits
+// instead of blocking, so it is safe to call from inside a task.
+struct WaitGroup {
+    std::atomic<int64_t> pending{0};
+};
+
+inline void wait_group_add(WaitGroup* wg, int64_t count) {
+    wg->pending.fetch_add(count, std::memory_order_relaxed);
+}
+
+inline void wait_group_done(WaitGroup* wg) {
+    wg->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void wait_group_wait(ThreadPool* pool, WaitGroup* wg);
+
+// Calls body(i) for every i in [begin, end), grain indices per task, and returns
+// once all of them have run.
+template <typename Body>
+void parallel_for(ThreadPool* pool, size_t begin, size_t end, size_t grain, Body body) {
+    if (grain == 0) {
+        grain = 1;
+    }
+    WaitGroup wg;
+    for (size_t chunk = begin; chunk < end; chunk += grain) {
+        size_t chunk_end = std::min(end, chunk + grain);
+        wait_group_add(&wg, 1);
+        submit(pool, [&wg, &body, chunk, chunk_end]() {
+            for (size_t i = chunk; i < chunk_end; ++i) {
+                body(i);
+            }
+            wait_group_done(&wg);
+        });
+    }
+    wait_group_wait(pool, &wg);
+}
+
+#endif
@@ -0,0 +1,32 @@
+#include "thread_registry.h"
+#include <atomic>
+#include <iostream>
+#include <cstdlib>
+
+static std::atomic<bool> slot_taken[MAX_THREADS];
+
+struct SlotHolder {
+    size_t slot;
+
+    SlotHolder() : slot(MAX_THREADS) {
+        for (size_t i = 0; i < MAX_THREADS; ++i) {
+            bool expected = false;
+            if (!slot_taken[i].load(std::memory_order_relaxed) &&
+                slot_taken[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                slot = i;
+                return;
+            }
+        }
+        std::cerr << "Error: More than " << MAX_THREADS << " threads are using the queue" << std::endl;
+        exit(1);
+    }
+
+    ~SlotHolder() {
+        slot_taken[slot].store(false, std::memory_order_release);
+    }
+};
+
+size_t currentThreadSlot() {
+    static thread_local SlotHolder holder;
+    return holder.slot;
+}
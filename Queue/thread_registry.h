@@ -0,0 +1,12 @@
+#ifndef THREAD_REGISTRY_H
+#define THREAD_REGISTRY_H
+
+#include <cstddef>
+
+constexpr size_t MAX_THREADS = 256;
+
+// Small dense index for the calling thread, stable for its lifetime and handed to
+// another thread once it exits. Per-thread state in the queues is indexed by it.
+size_t currentThreadSlot();
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef WS_DEQUE_H
+#define WS_DEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque in the C11 formulation of Le et al. The owning
+// thread pushes and pops at the bottom with plain loads and stores plus one
+// fence in pop; thieves take from the top with a CAS, and only the race for
+// the last element makes the owner CAS too. The circular array doubles when
+// full. Superseded arrays may still be read by a thief that loaded the old
+// pointer, so they are kept until the deque is deleted.
+template <typename T>
+struct WSDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "WSDeque slots are copied with atomic loads");
+
+    struct Array {
+        int64_t size;
+        std::atomic<T>* slots;
+
+        std::atomic<T>& at(int64_t i) { return slots[i & (size - 1)]; }
+    };
+
+    alignas(64) std::atomic<int64_t> top;
+    alignas(64) std::atomic<int64_t> bottom;
+    std::atomic<Array*> array;
+    // Owner only.
+    std::vector<Array*> retired;
+};
+
+template <typename T>
+typename WSDeque<T>::Array* makeWSArray(int64_t size) {
+    typename WSDeque<T>::Array* a = new typename WSDeque<T>::Array();
+    a->size = size;
+    a->slots = new std::atomic<T>[size];
+    return a;
+}
+
+// Capacity is rounded up to a power of two.
+template <typename T>
+WSDeque<T>* createWSDeque(size_t capacity = 1024) {
+    int64_t size = 2;
+    while (size < static_cast<int64_t>(capacity)) {
+        size <<= 1;
+    }
+
+    WSDeque<T>* d = new WSDeque<T>();
+    d->top.store(0, std::memory_order_relaxed);
+    d->bottom.store(0, std::memory_order_relaxed);
+    d->array.store(makeWSArray<T>(size), std::memory_order_relaxed);
+    return d;
+}
+
+// Not safe against concurrent use.
+template <typename T>
+void deleteWSDeque(WSDeque<T>* d) {
+    d->retired.push_back(d->array.load(std::memory_order_relaxed));
+    for (typename WSDeque<T>::Array* a : d->retired) {
+        delete[] a->slots;
+        delete a;
+    }
+    delete d;
+}
+
+// Owner only.
+template <typename T>
+void wsPush(WSDeque<T>* d, T value) {
+    int64_t b = d->bottom.load(std::memory_order_relaxed);
+    int64_t t = d->top.load(std::memory_order_acquire);
+    typename WSDeque<T>::Array* a = d->array.load(std::memory_order_relaxed);
+    if (b - t > a->size - 1) {
+        typename WSDeque<T>::Array* grown = makeWSArray<T>(a->size * 2);
+        for (int64_t i = t; i < b; ++i) {
+            grown->at(i).store(a->at(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        d->retired.push_back(a);
+        d->array.store(grown, std::memory_order_release);
+        a = grown;
+    }
+    a->at(b).store(value, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    d->bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+// Owner only. Takes the most recently pushed value.
+template <typename T>
+bool wsPop(WSDeque<T>* d, T& out) {
+    int64_t b = d->bottom.load(std::memory_order_relaxed) - 1;
+    typename WSDeque<T>::Array* a = d->array.load(std::memory_order_relaxed);
+    d->bottom.store(b, std::memory_order_relaxed);
+    // Orders the bottom claim before reading top; pairs with the fence in wsSteal.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = d->top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        d->bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+    out = a->at(b).load(std::memory_order_relaxed);
+    if (t == b) {
+        // Last element: race the thieves for it through top.
+        bool won = d->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed);
+        d->bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+// Any thread. Takes the oldest value; false when the deque looked empty or
+// another thief or the owner won the race, so callers simply move on.
+template <typename T>
+bool wsSteal(WSDeque<T>* d, T& out) {
+    int64_t t = d->top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = d->bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return false;
+    }
+    typename WSDeque<T>::Array* a = d->array.load(std::memory_order_acquire);
+    T value = a->at(t).load(std::memory_order_relaxed);
+    if (!d->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+// Racy snapshot, for load balancing and reporting.
+template <typename T>
+size_t wsSize(const WSDeque<T>* d) {
+    int64_t b = d->bottom.load(std::memory_order_relaxed);
+    int64_t t = d->top.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+}
+
+#endif